@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+// A set of MIDI notes (0-127) as a 128-bit bitmap
+class NoteSet {
+   public:
+    void set(int note) { words[index(note)] |= bit(note); }
+    void reset(int note) { words[index(note)] &= ~bit(note); }
+    bool test(int note) const { return (words[index(note)] & bit(note)) != 0; }
+    bool any() const { return (words[0] | words[1]) != 0; }
+    void clear() { words = {}; }
+
+    // Notes in this set that aren't in other
+    NoteSet without(const NoteSet& other) const {
+        NoteSet result;
+        result.words = {words[0] & ~other.words[0], words[1] & ~other.words[1]};
+        return result;
+    }
+
+    // Calls f(note) for each note, lowest first
+    template <typename F>
+    void forEach(F&& f) const {
+        for (size_t w = 0; w < words.size(); ++w) {
+            for (auto bits = words[w]; bits != 0; bits &= bits - 1) {
+                f(static_cast<int>((w * 64) + static_cast<size_t>(std::countr_zero(bits))));
+            }
+        }
+    }
+
+    bool operator==(const NoteSet&) const = default;
+
+   private:
+    std::array<uint64_t, 2> words{};
+
+    static size_t index(int note) { return static_cast<size_t>(note & 127) >> 6; }
+    static uint64_t bit(int note) { return uint64_t{1} << (note & 63); }
+};
+
+/*
+ * The notes the engine is holding on, per output channel (1-16).
+ *
+ * Used to move between chords with as few messages as possible, and to release everything at once.
+ * A channel mask keeps releasing everything proportional to the channels in use, not the notes.
+ */
+class ActiveNotes {
+   public:
+    static constexpr int NUM_CHANNELS = 16;
+
+    const NoteSet& on(int channel) const { return channels[slot(channel)]; }
+
+    void set(int channel, const NoteSet& notes) {
+        channels[slot(channel)] = notes;
+        auto mask = static_cast<uint16_t>(1u << slot(channel));
+        channelsInUse = notes.any() ? (channelsInUse | mask) : (channelsInUse & ~mask);
+    }
+
+    bool any() const { return channelsInUse != 0; }
+
+    // Calls f(channel, notes) for each channel with notes on
+    template <typename F>
+    void forEachChannel(F&& f) const {
+        for (unsigned bits = channelsInUse; bits != 0; bits &= bits - 1) {
+            auto s = static_cast<size_t>(std::countr_zero(bits));
+            f(static_cast<int>(s) + 1, channels[s]);
+        }
+    }
+
+    void clear() {
+        forEachChannel([this](int channel, const NoteSet&) { channels[slot(channel)].clear(); });
+        channelsInUse = 0;
+    }
+
+   private:
+    std::array<NoteSet, NUM_CHANNELS> channels{};
+    uint16_t channelsInUse = 0;
+
+    // Out of range channels are clamped, like MidiEvent does
+    static size_t slot(int channel) { return static_cast<size_t>(channel < 1 ? 0 : (channel > NUM_CHANNELS ? NUM_CHANNELS - 1 : channel - 1)); }
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+// Monotonic engine time, in integer nanoseconds
+using TimeNs = int64_t;
+
+constexpr TimeNs NS_PER_MS = 1'000'000;
+
+constexpr TimeNs msToNs(double ms) { return static_cast<TimeNs>(ms * static_cast<double>(NS_PER_MS)); }
+constexpr TimeNs msToNs(int ms) { return static_cast<TimeNs>(ms) * NS_PER_MS; }
+constexpr double nsToMs(TimeNs ns) { return static_cast<double>(ns) / static_cast<double>(NS_PER_MS); }
+
+// Source of engine time. Read it once per batch, not once per message.
+class MonotonicClock {
+   public:
+    virtual ~MonotonicClock() = default;
+    virtual TimeNs now() const = 0;
+};
+
+// Real time, on the same base as juce::Time::getMillisecondCounterHiRes() and JUCE's MIDI input timestamps
+class SystemClock : public MonotonicClock {
+   public:
+    TimeNs now() const override { return msToNs(juce::Time::getMillisecondCounterHiRes()); }
+
+    // MIDI input timestamps are in seconds on the same base
+    static TimeNs fromMidiTimestamp(double seconds) { return static_cast<TimeNs>(std::llround(seconds * 1e9)); }
+
+    static const SystemClock& instance() {
+        static const SystemClock clock;
+        return clock;
+    }
+};
+
+// Time that only moves when told to, for simulations, offline renders and deterministic benchmarks
+class VirtualClock : public MonotonicClock {
+   public:
+    explicit VirtualClock(TimeNs start = 0) : current(start) {}
+
+    TimeNs now() const override { return current.load(std::memory_order_acquire); }
+
+    void advance(TimeNs delta) { current.fetch_add(delta, std::memory_order_acq_rel); }
+    void set(TimeNs time) { current.store(time, std::memory_order_release); }
+
+   private:
+    std::atomic<TimeNs> current;
+};
@@ -0,0 +1,34 @@
+#include "CompiledSettings.h"
+
+#include <juce_core/juce_core.h>
+
+std::shared_ptr<CompiledSettings> CompiledSettings::compile(std::shared_ptr<OmnifySettings> settings) {
+    auto compiled = std::make_shared<CompiledSettings>();
+
+    if (settings->chordVoicingStyle) {
+        // Read before compiling, so data published mid-compile still marks this stale
+        compiled->chordDataVersion = settings->chordVoicingStyle->getDataVersion();
+        compileChordVoicings(compiled->chordVoicings, *settings->chordVoicingStyle, settings->voicingModifier);
+        if (compiled->chordVoicings.getNumFailedEntries() > 0) {
+            DBG("CompiledSettings: " << compiled->chordVoicings.getNumFailedEntries()
+                                     << " chord voicings failed, first error: " << compiled->chordVoicings.getFirstError());
+        }
+    }
+    if (settings->strumVoicingStyle) {
+        compiled->strumDataVersion = settings->strumVoicingStyle->getDataVersion();
+        compileStrumVoicings(compiled->strumVoicings, *settings->strumVoicingStyle);
+        if (compiled->strumVoicings.getNumFailedEntries() > 0) {
+            DBG("CompiledSettings: " << compiled->strumVoicings.getNumFailedEntries()
+                                     << " strum voicings failed, first error: " << compiled->strumVoicings.getFirstError());
+        }
+    }
+
+    compiled->inputRoutes = InputRoutingTable::compile(*settings);
+    compiled->settings = std::move(settings);
+    return compiled;
+}
+
+bool CompiledSettings::isStale() const {
+    return (settings->chordVoicingStyle && settings->chordVoicingStyle->getDataVersion() != chordDataVersion) ||
+           (settings->strumVoicingStyle && settings->strumVoicingStyle->getDataVersion() != strumDataVersion);
+}
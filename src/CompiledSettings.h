@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "InputRouting.h"
+#include "VoicingTable.h"
+#include "datamodel/OmnifySettings.h"
+
+/*
+ * An OmnifySettings snapshot plus everything the engine derives from it.
+ *
+ * Compiled on the message thread whenever settings change, then treated as immutable,
+ * so the per-message path only does table lookups.
+ */
+struct CompiledSettings {
+    std::shared_ptr<OmnifySettings> settings;
+    ChordVoicingTable chordVoicings;
+    StrumVoicingTable strumVoicings;
+    InputRoutingTable inputRoutes;
+
+    // Voicing style data versions the tables were built from
+    uint64_t chordDataVersion = 0;
+    uint64_t strumDataVersion = 0;
+
+    static std::shared_ptr<CompiledSettings> compile(std::shared_ptr<OmnifySettings> settings);
+
+    // True if a voicing style's data has changed since compiling, eg a chord file finished loading
+    bool isStale() const;
+};
@@ -2,7 +2,7 @@
 
 #include <juce_core/juce_core.h>
 
-#include <climits>
+#include <algorithm>
 #include <utility>
 
 #include "MidiMessageScheduler.h"
@@ -31,36 +31,155 @@ void Daemomnify::setInputDevice(std::optional<juce::String> newDeviceId) {
     deviceId = std::move(newDeviceId);
 }
 
+void Daemomnify::setWakeMode(WakeMode mode) {
+    wakeMode.store(mode);
+    // Wake the engine so it picks up the new mode immediately rather than after its current wait
+    notify();
+}
+
+void Daemomnify::handleIncomingMidiMessage(juce::MidiInput* source, const juce::MidiMessage& message) {
+    // JUCE stamps input with the driver's arrival time, on the same base as SystemClock
+    auto arrival = message.getTimeStamp() > 0 ? SystemClock::fromMidiTimestamp(message.getTimeStamp()) : clock.now();
+
+    TimestampedMidiEvent event;
+    if (!TimestampedMidiEvent::fromMidiMessage(message, arrival, event)) {
+        return;  // sysex etc, nothing Omnify reacts to
+    }
+    if (!inputQueue.push(event)) {
+        // Logged by the engine thread, so a burst of drops is one log record rather than one each
+        droppedInputCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (wakeMode.load(std::memory_order_relaxed) == WakeMode::EventDriven) {
+        notify();
+    }
+}
+
+Daemomnify::QueueDelayStats Daemomnify::getQueueDelayStats() const {
+    return QueueDelayStats{
+        .count = queueDelayCount.load(std::memory_order_relaxed),
+        .totalMs = queueDelayTotalMs.load(std::memory_order_relaxed),
+        .maxMs = queueDelayMaxMs.load(std::memory_order_relaxed),
+    };
+}
+
+void Daemomnify::resetQueueDelayStats() { queueDelayResetRequested.store(true); }
+
+void Daemomnify::resetLatencyStats() {
+    inputLatency.reset();
+    schedulerLateness.reset();
+}
+
+void Daemomnify::recordQueueDelays(size_t batchSize, TimeNs now) {
+    // Single writer, so plain load / store is enough. Resets are applied here to keep it that way.
+    if (queueDelayResetRequested.exchange(false)) {
+        queueDelayCount.store(0, std::memory_order_relaxed);
+        queueDelayTotalMs.store(0, std::memory_order_relaxed);
+        queueDelayMaxMs.store(0, std::memory_order_relaxed);
+    }
+
+    auto total = queueDelayTotalMs.load(std::memory_order_relaxed);
+    auto max = queueDelayMaxMs.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < batchSize; ++i) {
+        auto delayMs = nsToMs(std::max<TimeNs>(0, now - batch[i].timeNs));
+        total += delayMs;
+        max = std::max(max, delayMs);
+    }
+    queueDelayTotalMs.store(total, std::memory_order_relaxed);
+    queueDelayMaxMs.store(max, std::memory_order_relaxed);
+    queueDelayCount.fetch_add(batchSize, std::memory_order_relaxed);
+}
+
+size_t Daemomnify::drainInputQueue() {
+    size_t n = 0;
+    while (n < batch.size() && inputQueue.pop(batch[n])) {
+        ++n;
+    }
+    return n;
+}
+
+void Daemomnify::recordInputLatency(size_t batchSize, TimeNs sentTime) {
+    // The whole batch's output has been handed to the port by sentTime, so one clock read covers all of it
+    for (size_t i = 0; i < batchSize; ++i) {
+        inputLatency.record(sentTime - batch[i].timeNs);
+    }
+}
+
+int Daemomnify::computeWaitMs(TimeNs now, bool hasOutput) const {
+    if (wakeMode.load(std::memory_order_relaxed) == WakeMode::Polling) {
+        return POLL_INTERVAL_MS;
+    }
+
+    // Overdue messages can't be sent without an output, so waiting for them would spin.
+    // Opening the output notifies the thread.
+    if (!hasOutput) {
+        return -1;
+    }
+
+    // Only touched by the engine thread, so no lock needed
+    auto nextSendTime = scheduler.nextSendTime();
+    if (!nextSendTime) {
+        return -1;  // nothing scheduled, sleep until notified
+    }
+
+    auto untilDue = *nextSendTime - now;
+    if (untilDue <= 0) {
+        return 0;
+    }
+    return static_cast<int>((untilDue + NS_PER_MS - 1) / NS_PER_MS);
+}
+
 void Daemomnify::run() {
+    // The in-host path shares the scheduler, so only measure it while this thread is driving it
+    scheduler.setLatenessHistogram(&schedulerLateness);
+    logger->logRealtime("Engine thread started");
+    auto schedulerDropped = scheduler.getNumDropped();
+    auto inputDropped = droppedInputCount.load(std::memory_order_relaxed);
+
     while (!threadShouldExit()) {
-        // Process incoming MIDI messages
-        {
-            std::scoped_lock lock(deviceMutex);
-            if (midiInput && midiOutput) {
-                juce::MidiBuffer buffer;
-                midiCollector.removeNextBlockOfMessages(buffer, INT_MAX);
-
-                for (const auto metadata : buffer) {
-                    try {
-                        auto toSend = omnify.handle(metadata.getMessage());
-                        for (const auto& m : toSend) {
-                            midiOutput->sendMessageNow(m);
-                        }
-                    } catch (const std::exception& e) {
-                        DBG("Daemomnify: exception in handle(): " << e.what());
-                    }
-                }
+        auto* output = activeOutput.load(std::memory_order_acquire);
+
+        // Process incoming MIDI messages a batch at a time.
+        // Drain even without an output so stale input doesn't pile up.
+        size_t batchSize = 0;
+        while ((batchSize = drainInputQueue()) > 0) {
+            if (output == nullptr) {
+                continue;
             }
+            // One clock read per batch, not per message
+            recordQueueDelays(batchSize, clock.now());
+            outputSink.setOutput(output);
+            omnify.process(std::span(batch.data(), batchSize), outputSink);
+            recordInputLatency(batchSize, clock.now());
+        }
 
-            // Send any scheduled messages whose time has arrived
-            if (midiOutput) {
-                double now = juce::Time::getMillisecondCounterHiRes();
-                scheduler.sendOverdueMessages(now, *midiOutput);
-            }
+        // Send any scheduled messages whose time has arrived
+        auto now = clock.now();
+        if (output != nullptr) {
+            outputSink.setOutput(output);
+            scheduler.sendOverdueMessages(now, outputSink);
+        }
+
+        if (scheduler.getNumDropped() != schedulerDropped) {
+            logger->logRealtime("Scheduler full, dropped %llu scheduled messages",
+                                static_cast<unsigned long long>(scheduler.getNumDropped() - schedulerDropped));
+            schedulerDropped = scheduler.getNumDropped();
+        }
+        if (auto dropped = droppedInputCount.load(std::memory_order_relaxed); dropped != inputDropped) {
+            logger->logRealtime("Input queue full, dropped %llu MIDI messages (%llu dropped so far)",
+                                static_cast<unsigned long long>(dropped - inputDropped), static_cast<unsigned long long>(dropped));
+            inputDropped = dropped;
         }
 
-        wait(POLL_INTERVAL_MS);
+        auto waitMs = computeWaitMs(now, output != nullptr);
+        if (waitMs != 0) {
+            wait(waitMs);
+        }
+        wakeupCount.fetch_add(1, std::memory_order_relaxed);
     }
+
+    scheduler.setLatenessHistogram(nullptr);
+    logger->logRealtime("Engine thread stopped");
 }
 
 void Daemomnify::checkDevices() {
@@ -87,16 +206,14 @@ void Daemomnify::checkDevices() {
 }
 
 bool Daemomnify::openMidiInput(const juce::String& inputDeviceId) {
-    double now = juce::Time::getMillisecondCounterHiRes();
-    if (now < lastInputOpenAttemptMs + RETRY_INTERVAL_MS) {
+    auto now = clock.now();
+    if (now < lastInputOpenAttempt + msToNs(RETRY_INTERVAL_MS)) {
         return false;
     }
-    lastInputOpenAttemptMs = now;
+    lastInputOpenAttempt = now;
 
-    std::scoped_lock lock(deviceMutex);
-    midiInput = juce::MidiInput::openDevice(inputDeviceId, &midiCollector);
+    midiInput = juce::MidiInput::openDevice(inputDeviceId, this);
     if (midiInput) {
-        midiCollector.reset(44100.0);
         midiInput->start();
         return true;
     }
@@ -104,7 +221,6 @@ bool Daemomnify::openMidiInput(const juce::String& inputDeviceId) {
 }
 
 void Daemomnify::closeMidiInput() {
-    std::scoped_lock lock(deviceMutex);
     if (midiInput) {
         midiInput->stop();
         midiInput.reset();
@@ -112,12 +228,18 @@ void Daemomnify::closeMidiInput() {
 }
 
 bool Daemomnify::openMidiOutput() {
-    std::scoped_lock lock(deviceMutex);
     midiOutput = juce::MidiOutput::createNewDevice(outputPortName);
-    return midiOutput != nullptr;
+    activeOutput.store(midiOutput.get(), std::memory_order_release);
+    if (midiOutput == nullptr) {
+        return false;
+    }
+    // The engine thread may be sleeping on messages it couldn't send without an output
+    notify();
+    return true;
 }
 
 void Daemomnify::closeMidiOutput() {
-    std::scoped_lock lock(deviceMutex);
+    // Only called from stop(), once the engine thread is no longer using the output
+    activeOutput.store(nullptr, std::memory_order_release);
     midiOutput.reset();
 }
@@ -3,14 +3,28 @@
 #include <juce_audio_devices/juce_audio_devices.h>
 #include <juce_core/juce_core.h>
 
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <mutex>
 #include <optional>
 
+#include "Clock.h"
+#include "LatencyHistogram.h"
+#include "MidiOutputSink.h"
+#include "OmnifyLogger.h"
+#include "SpscQueue.h"
+#include "TimestampedMidiEvent.h"
+
 class MidiMessageScheduler;
 class Omnify;
 
-class Daemomnify : private juce::Thread {
+class Daemomnify : private juce::Thread, private juce::MidiInputCallback {
    public:
+    // Polling wakes every POLL_INTERVAL_MS regardless of activity.
+    // EventDriven sleeps until the MIDI input callback signals new data, or until the next scheduled message is due.
+    enum class WakeMode { Polling, EventDriven };
+
     Daemomnify(Omnify& omnify, MidiMessageScheduler& scheduler, juce::String outputPortName);
     ~Daemomnify() override;
 
@@ -23,11 +37,43 @@ class Daemomnify : private juce::Thread {
 
     void setInputDevice(std::optional<juce::String> deviceId);
 
+    void setWakeMode(WakeMode mode);
+    WakeMode getWakeMode() const { return wakeMode.load(); }
+
+    // Number of times the engine thread has woken up, for comparing wake modes
+    uint64_t getWakeupCount() const { return wakeupCount.load(std::memory_order_relaxed); }
+
+    // Time from a message arriving at the MIDI input to the engine processing it
+    struct QueueDelayStats {
+        uint64_t count = 0;
+        double totalMs = 0;
+        double maxMs = 0;
+
+        double meanMs() const { return count > 0 ? totalMs / static_cast<double>(count) : 0; }
+    };
+    QueueDelayStats getQueueDelayStats() const;
+    void resetQueueDelayStats();
+
+    // Time from a message arriving at the MIDI input to its batch's output being handed to the output port
+    LatencyHistogram::Snapshot getInputLatency() const { return inputLatency.getSnapshot(); }
+    // How late scheduled messages (eg strum note-offs) are sent, compared to when they were due
+    LatencyHistogram::Snapshot getSchedulerLateness() const { return schedulerLateness.getSnapshot(); }
+    void resetLatencyStats();
+
+    // Number of input messages dropped because the input queue was full
+    uint64_t getDroppedInputCount() const { return droppedInputCount.load(std::memory_order_relaxed); }
+
     // Called from message thread by PluginProcessor timer
     void checkDevices();
 
    private:
+    static constexpr size_t INPUT_QUEUE_CAPACITY = 1024;
+    static constexpr size_t MAX_BATCH_SIZE = 256;
+
     void run() override;
+    void handleIncomingMidiMessage(juce::MidiInput* source, const juce::MidiMessage& message) override;
+    size_t drainInputQueue();
+    int computeWaitMs(TimeNs now, bool hasOutput) const;
     bool openMidiInput(const juce::String& deviceId);
     void closeMidiInput();
     bool openMidiOutput();
@@ -35,14 +81,46 @@ class Daemomnify : private juce::Thread {
 
     Omnify& omnify;
     MidiMessageScheduler& scheduler;
+    const SystemClock& clock = SystemClock::instance();  // talks to real devices, so always real time
 
+    // Devices are opened and closed on the message thread only
     std::unique_ptr<juce::MidiInput> midiInput;
     std::unique_ptr<juce::MidiOutput> midiOutput;
-    juce::MidiMessageCollector midiCollector;
+
+    // What the engine thread sends to. Set once the output is open, and only
+    // cleared after the engine thread has stopped, so it never needs a lock.
+    std::atomic<juce::MidiOutput*> activeOutput{nullptr};
+
+    // Filled by the MIDI input callback, drained by the engine thread.
+    // Only one input device is open at a time, so there is only ever one producer.
+    SpscQueue<TimestampedMidiEvent, INPUT_QUEUE_CAPACITY> inputQueue;
+    std::atomic<uint64_t> droppedInputCount{0};
+
+    // Written by the engine thread only
+    std::atomic<uint64_t> queueDelayCount{0};
+    std::atomic<double> queueDelayTotalMs{0};
+    std::atomic<double> queueDelayMaxMs{0};
+    std::atomic<bool> queueDelayResetRequested{false};
+    void recordQueueDelays(size_t batchSize, TimeNs now);
+
+    // Recorded by the engine thread only, readable from anywhere
+    LatencyHistogram inputLatency;
+    LatencyHistogram schedulerLateness;
+    void recordInputLatency(size_t batchSize, TimeNs sentTime);
+
+    // Engine thread only
+    std::array<TimestampedMidiEvent, MAX_BATCH_SIZE> batch;
+    MidiOutputSink outputSink;
 
     std::optional<juce::String> deviceId;
-    mutable std::mutex deviceMutex;
-    double lastInputOpenAttemptMs = 0;
+    mutable std::mutex deviceMutex;  // guards deviceId
+    TimeNs lastInputOpenAttempt = 0;
+
+    // Only logRealtime() may be used from the engine thread and the MIDI callback
+    juce::SharedResourcePointer<OmnifyLogger> logger;
+
+    std::atomic<WakeMode> wakeMode{WakeMode::EventDriven};
+    std::atomic<uint64_t> wakeupCount{0};
 
     juce::String outputPortName;
 
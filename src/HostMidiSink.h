@@ -0,0 +1,36 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "MidiSink.h"
+
+/*
+ * Writes engine output into a host MidiBuffer, converting each message's time to a
+ * sample offset within the current block.
+ *
+ * Messages due before the block starts land on its first sample; anything due
+ * at or after the end of the block lands on its last sample.
+ */
+class HostMidiSink : public MidiSink {
+   public:
+    void beginBlock(juce::MidiBuffer& output, TimeNs blockStartTimeNs, double sampleRate, int numSamples) {
+        buffer = &output;
+        blockStartNs = blockStartTimeNs;
+        samplesPerNs = sampleRate / 1e9;
+        lastSample = std::max(0, numSamples - 1);
+    }
+
+    void send(MidiEvent event, TimeNs timeNs) override {
+        auto offset = static_cast<int>(std::floor(static_cast<double>(timeNs - blockStartNs) * samplesPerNs));
+        buffer->addEvent(event.bytes.data(), static_cast<int>(event.bytes.size()), juce::jlimit(0, lastSample, offset));
+    }
+
+   private:
+    juce::MidiBuffer* buffer = nullptr;
+    TimeNs blockStartNs = 0;
+    double samplesPerNs = 44100.0 / 1e9;
+    int lastSample = 0;
+};
@@ -0,0 +1,72 @@
+#include "InputRouting.h"
+
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "MidiEvent.h"
+
+namespace {
+
+constexpr uint8_t CC_ON_VALUE = 64;  // CC buttons count as pressed above 63
+
+bool isMidiNumber(int n) { return n >= 0 && n < 128; }
+
+}  // namespace
+
+InputRoutingTable InputRoutingTable::compile(const OmnifySettings& settings) {
+    InputRoutingTable table;
+    auto& noteOns = table.routes[NOTE_ON_ROW];
+    auto& noteOffs = table.routes[NOTE_OFF_ROW];
+    auto& controllers = table.routes[CONTROLLER_ROW];
+
+    // Lowest priority first, so each later assignment takes over a shared note or CC
+    for (auto& route : noteOns) {
+        route.action = InputAction::CHORD_NOTE_ON;
+    }
+    for (auto& route : noteOffs) {
+        route.action = InputAction::CHORD_NOTE_OFF;
+    }
+    controllers[MidiEvent::ALL_NOTES_OFF_CC].action = InputAction::ALL_NOTES_OFF;
+    if (isMidiNumber(settings.strumPlateCC)) {
+        controllers[static_cast<size_t>(settings.strumPlateCC)].action = InputAction::STRUM;
+    }
+
+    for (auto [button, action] : {std::pair{&settings.latchButton, InputAction::LATCH}, std::pair{&settings.stopButton, InputAction::STOP}}) {
+        if (isMidiNumber(button->note)) {
+            noteOns[static_cast<size_t>(button->note)] = InputRoute{.action = action};
+        }
+        if (isMidiNumber(button->cc)) {
+            controllers[static_cast<size_t>(button->cc)] = InputRoute{.action = action, .toggle = action == InputAction::LATCH && button->ccIsToggle};
+        }
+    }
+
+    std::visit(
+        [&](auto&& style) {
+            using T = std::decay_t<decltype(style)>;
+            if constexpr (std::is_same_v<T, ButtonPerChordQuality>) {
+                for (const auto& [note, quality] : style.notes) {
+                    if (isMidiNumber(note)) {
+                        noteOns[static_cast<size_t>(note)] = InputRoute{.action = InputAction::CHORD_QUALITY, .quality = quality};
+                    }
+                }
+                // Only a press selects the quality, a release falls through to whatever else is on that CC
+                for (const auto& [cc, quality] : style.ccs) {
+                    if (isMidiNumber(cc)) {
+                        auto& route = controllers[static_cast<size_t>(cc)];
+                        route.belowMinValue = route.action;
+                        route.action = InputAction::CHORD_QUALITY;
+                        route.minValue = CC_ON_VALUE;
+                        route.quality = quality;
+                    }
+                }
+            } else if constexpr (std::is_same_v<T, CCRangePerChordQuality>) {
+                if (isMidiNumber(style.cc)) {
+                    controllers[static_cast<size_t>(style.cc)] = InputRoute{.action = InputAction::CHORD_QUALITY_RANGE};
+                }
+            }
+        },
+        settings.chordQualitySelectionStyle.value);
+
+    return table;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "datamodel/ChordQuality.h"
+#include "datamodel/OmnifySettings.h"
+
+// What the engine does with an input message
+enum class InputAction : uint8_t {
+    NONE,
+    CHORD_QUALITY,        // enqueue route.quality
+    CHORD_QUALITY_RANGE,  // enqueue the quality the CC value falls in
+    STOP,
+    LATCH,
+    CHORD_NOTE_ON,
+    CHORD_NOTE_OFF,
+    STRUM,
+    ALL_NOTES_OFF,  // release everything the engine is holding, for a controller's panic button
+};
+
+struct InputRoute {
+    InputAction action = InputAction::NONE;
+    // Values (velocity or CC value) below this go to belowMinValue instead, eg a quality button's CC being released
+    uint8_t minValue = 0;
+    InputAction belowMinValue = InputAction::NONE;
+    ChordQuality quality = ChordQuality::MAJOR;
+    bool toggle = false;  // LATCH only: the CC value sets latch on or off instead of flipping it
+
+    InputAction actionFor(uint8_t value) const noexcept { return value >= minValue ? action : belowMinValue; }
+};
+
+/*
+ * Where every input message goes, indexed by (status, data1).
+ *
+ * Compiled from the button, quality selection and strum settings when settings change, resolving
+ * overlaps between them in the order they've always been checked: quality selection, stop, latch,
+ * then chord notes and the strum plate. All Notes Off (CC 123) comes last, so it can still be assigned.
+ * Dispatching a message is then a single lookup, on any channel.
+ */
+class InputRoutingTable {
+   public:
+    static InputRoutingTable compile(const OmnifySettings& settings);
+
+    // Note-ons with velocity 0 are note-offs
+    const InputRoute& lookup(uint8_t status, uint8_t data1, uint8_t data2) const noexcept {
+        auto row = static_cast<size_t>((status >> 4) & 7);
+        if (row == NOTE_ON_ROW && data2 == 0) {
+            row = NOTE_OFF_ROW;
+        }
+        return routes[row][data1 & 127];
+    }
+
+   private:
+    // Rows are status 0x8n to 0xFn, channel ignored
+    static constexpr size_t NOTE_OFF_ROW = 0;
+    static constexpr size_t NOTE_ON_ROW = 1;
+    static constexpr size_t CONTROLLER_ROW = 3;
+
+    std::array<std::array<InputRoute, 128>, 8> routes{};
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include "Clock.h"
+
+/*
+ * Fixed-bucket histogram of latencies, written by one thread and readable from any other.
+ *
+ * Buckets are log-linear: each power of two is split into SUB_BUCKETS equal parts,
+ * so percentiles are within 1 / SUB_BUCKETS of the true value at any scale.
+ * Recording is a handful of relaxed atomic ops and never locks or allocates.
+ * Readers may see a sample or two mid-update, which is fine for statistics.
+ */
+class LatencyHistogram {
+   public:
+    static constexpr int SUB_BUCKET_BITS = 3;
+    static constexpr size_t SUB_BUCKETS = size_t{1} << SUB_BUCKET_BITS;
+    static constexpr size_t NUM_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    struct Snapshot {
+        uint64_t count = 0;
+        TimeNs p50Ns = 0;
+        TimeNs p99Ns = 0;
+        TimeNs maxNs = 0;
+    };
+
+    LatencyHistogram() = default;
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    // Writer thread only. Negative latencies (eg clock skew) count as zero.
+    void record(TimeNs latencyNs) {
+        if (resetRequested.load(std::memory_order_relaxed) && resetRequested.exchange(false)) {
+            for (auto& bucket : buckets) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+            maxNs.store(0, std::memory_order_relaxed);
+        }
+
+        auto value = static_cast<uint64_t>(std::max<TimeNs>(0, latencyNs));
+        auto& bucket = buckets[bucketOf(value)];
+        // Single writer, so plain load / store is enough
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (static_cast<TimeNs>(value) > maxNs.load(std::memory_order_relaxed)) {
+            maxNs.store(static_cast<TimeNs>(value), std::memory_order_relaxed);
+        }
+    }
+
+    // Any thread. The writer applies the reset on its next record, to stay the only writer.
+    void reset() { resetRequested.store(true); }
+
+    // Any thread. Percentiles are reported as the upper edge of their bucket, capped at the max.
+    Snapshot getSnapshot() const {
+        std::array<uint64_t, NUM_BUCKETS> counts{};
+        Snapshot snapshot;
+        for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+            counts[i] = buckets[i].load(std::memory_order_relaxed);
+            snapshot.count += counts[i];
+        }
+        snapshot.maxNs = maxNs.load(std::memory_order_relaxed);
+        if (snapshot.count == 0) {
+            return snapshot;
+        }
+        snapshot.p50Ns = std::min(snapshot.maxNs, percentile(counts, snapshot.count, 50));
+        snapshot.p99Ns = std::min(snapshot.maxNs, percentile(counts, snapshot.count, 99));
+        return snapshot;
+    }
+
+   private:
+    std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets{};
+    std::atomic<TimeNs> maxNs{0};
+    std::atomic<bool> resetRequested{false};
+
+    static size_t bucketOf(uint64_t value) {
+        if (value < SUB_BUCKETS) {
+            return static_cast<size_t>(value);
+        }
+        auto shift = static_cast<size_t>(std::bit_width(value)) - 1 - SUB_BUCKET_BITS;
+        auto sub = static_cast<size_t>(value >> shift) & (SUB_BUCKETS - 1);
+        return ((shift + 1) * SUB_BUCKETS) + sub;
+    }
+
+    static TimeNs upperEdgeOf(size_t bucket) {
+        if (bucket < SUB_BUCKETS) {
+            return static_cast<TimeNs>(bucket);
+        }
+        auto shift = (bucket / SUB_BUCKETS) - 1;
+        auto lower = (SUB_BUCKETS + (bucket % SUB_BUCKETS)) << shift;
+        auto upper = lower + ((size_t{1} << shift) - 1);
+        return static_cast<TimeNs>(std::min<uint64_t>(upper, static_cast<uint64_t>(INT64_MAX)));
+    }
+
+    static TimeNs percentile(const std::array<uint64_t, NUM_BUCKETS>& counts, uint64_t total, uint64_t percent) {
+        // Smallest bucket holding at least percent% of the samples
+        auto target = std::max<uint64_t>(1, ((total * percent) + 99) / 100);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+            seen += counts[i];
+            if (seen >= target) {
+                return upperEdgeOf(i);
+            }
+        }
+        return upperEdgeOf(NUM_BUCKETS - 1);
+    }
+};
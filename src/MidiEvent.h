@@ -0,0 +1,43 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <algorithm>
+#include <array>
+#include <type_traits>
+
+/*
+ * A 3-byte channel message, packed into 4 bytes. Everything the engine sends is one of these.
+ *
+ * Used for the engine's output all the way through the scheduler and into MidiSink,
+ * so it's only turned into a juce::MidiMessage (or written straight into a MidiBuffer) at the sink.
+ */
+struct alignas(4) MidiEvent {
+    static constexpr int ALL_NOTES_OFF_CC = 123;
+
+    std::array<juce::uint8, 3> bytes{};
+
+    // Channels are 1-16, clamped the same way as juce::MidiMessage
+    static constexpr MidiEvent noteOn(int channel, int note, juce::uint8 velocity) {
+        return {{statusByte(0x90, channel), static_cast<juce::uint8>(note & 127), static_cast<juce::uint8>(velocity & 127)}};
+    }
+    static constexpr MidiEvent noteOff(int channel, int note) { return {{statusByte(0x80, channel), static_cast<juce::uint8>(note & 127), 0}}; }
+    static constexpr MidiEvent controller(int channel, int cc, int value) {
+        return {{statusByte(0xb0, channel), static_cast<juce::uint8>(cc & 127), static_cast<juce::uint8>(value & 127)}};
+    }
+    static constexpr MidiEvent allNotesOff(int channel) { return controller(channel, ALL_NOTES_OFF_CC, 0); }
+
+    constexpr int getChannel() const { return (bytes[0] & 0x0f) + 1; }
+    constexpr int getNoteNumber() const { return bytes[1]; }
+    constexpr juce::uint8 getVelocity() const { return bytes[2]; }
+
+    juce::MidiMessage toMidiMessage() const { return juce::MidiMessage(bytes[0], bytes[1], bytes[2]); }
+
+    constexpr bool operator==(const MidiEvent&) const = default;
+
+   private:
+    static constexpr juce::uint8 statusByte(int type, int channel) { return static_cast<juce::uint8>(type | std::clamp(channel - 1, 0, 15)); }
+};
+
+static_assert(sizeof(MidiEvent) == 4);
+static_assert(std::is_trivially_copyable_v<MidiEvent>);
@@ -1,14 +1,209 @@
 #include "MidiMessageScheduler.h"
 
-void MidiMessageScheduler::schedule(const juce::MidiMessage& msg, double currentTimeMs, double delayMs) {
-    queue.push(ScheduledMidiMessage{.sendTimeMs = currentTimeMs + delayMs, .message = msg});
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+MidiMessageScheduler::MidiMessageScheduler(size_t capacity)
+    : entries(capacity), bucketHeads(NUM_BUCKETS, NONE), occupiedBuckets(NUM_BUCKETS / 64, 0) {
+    clear();
+}
+
+ScheduledMessageHandle MidiMessageScheduler::schedule(MidiEvent event, TimeNs currentTime, TimeNs delay) {
+    if (freeHead == NONE) {
+        ++numDropped;
+        return {};
+    }
+
+    auto index = freeHead;
+    auto& e = entries[index];
+    freeHead = e.next;
+
+    e.sendTime = currentTime + delay;
+    e.event = event;
+    ++e.generation;
+    link(index);
+    ++numPending;
+
+    return ScheduledMessageHandle{.slot = index, .generation = e.generation};
+}
+
+bool MidiMessageScheduler::reschedule(ScheduledMessageHandle handle, TimeNs sendTime) {
+    auto* e = find(handle);
+    if (e == nullptr) {
+        return false;
+    }
+    unlink(handle.slot);
+    e->sendTime = sendTime;
+    link(handle.slot);
+    return true;
+}
+
+bool MidiMessageScheduler::cancel(ScheduledMessageHandle handle) {
+    if (find(handle) == nullptr) {
+        return false;
+    }
+    unlink(handle.slot);
+    release(handle.slot);
+    return true;
+}
+
+bool MidiMessageScheduler::isPending(ScheduledMessageHandle handle) const { return find(handle) != nullptr; }
+
+void MidiMessageScheduler::sendOverdueMessages(TimeNs currentTime, MidiSink& sink) {
+    auto lastTick = tickOf(currentTime);
+    if (numPending == 0 || lastTick < nextTick) {
+        nextTick = std::max(nextTick, lastTick);
+        return;
+    }
+
+    // Visit each bucket at most once, even after a long gap between calls.
+    // Entries carry their exact send time, so buckets holding later laps of the wheel are handled correctly.
+    auto numTicks = static_cast<size_t>(std::min<int64_t>(lastTick - nextTick + 1, static_cast<int64_t>(NUM_BUCKETS)));
+    auto start = bucketOf(nextTick);
+
+    size_t distance = 0;
+    while (numPending > 0) {
+        distance += nextOccupiedBucket((start + distance) & BUCKET_MASK, numTicks - distance);
+        if (distance >= numTicks) {
+            break;
+        }
+
+        auto index = bucketHeads[(start + distance) & BUCKET_MASK];
+        while (index != NONE) {
+            auto next = entries[index].next;
+            if (entries[index].sendTime <= currentTime) {
+                sink.send(entries[index].event, entries[index].sendTime);
+                if (latenessHistogram != nullptr) {
+                    latenessHistogram->record(currentTime - entries[index].sendTime);
+                }
+                unlink(index);
+                release(index);
+            }
+            index = next;
+        }
+        ++distance;
+    }
+
+    // The current tick may still hold messages due later in this millisecond, so revisit it next time
+    nextTick = lastTick;
+}
+
+void MidiMessageScheduler::clear() {
+    std::fill(bucketHeads.begin(), bucketHeads.end(), NONE);
+    std::fill(occupiedBuckets.begin(), occupiedBuckets.end(), 0);
+
+    freeHead = NONE;
+    for (size_t i = entries.size(); i-- > 0;) {
+        auto& e = entries[i];
+        if (e.isPending()) {
+            ++e.generation;  // invalidate outstanding handles
+        }
+        e.prev = NONE;
+        e.next = freeHead;
+        freeHead = static_cast<uint32_t>(i);
+    }
+    numPending = 0;
+}
+
+std::optional<TimeNs> MidiMessageScheduler::nextSendTime() const {
+    if (numPending == 0) {
+        return std::nullopt;
+    }
+
+    // The first occupied bucket holding an entry for this lap of the wheel has the earliest message
+    auto start = bucketOf(nextTick);
+    size_t distance = 0;
+    while (true) {
+        distance += nextOccupiedBucket((start + distance) & BUCKET_MASK, NUM_BUCKETS - distance);
+        if (distance >= NUM_BUCKETS) {
+            break;
+        }
+
+        auto tick = nextTick + static_cast<int64_t>(distance);
+        std::optional<TimeNs> earliest;
+        for (auto index = bucketHeads[(start + distance) & BUCKET_MASK]; index != NONE; index = entries[index].next) {
+            const auto& e = entries[index];
+            if (linkedTick(e) == tick && (!earliest || e.sendTime < *earliest)) {
+                earliest = e.sendTime;
+            }
+        }
+        if (earliest) {
+            return earliest;
+        }
+        ++distance;
+    }
+
+    // Everything pending is more than a full lap away
+    auto earliest = std::numeric_limits<TimeNs>::max();
+    for (const auto& e : entries) {
+        if (e.isPending()) {
+            earliest = std::min(earliest, e.sendTime);
+        }
+    }
+    return earliest;
+}
+
+MidiMessageScheduler::Entry* MidiMessageScheduler::find(ScheduledMessageHandle handle) {
+    if (handle.slot >= entries.size()) {
+        return nullptr;
+    }
+    auto& e = entries[handle.slot];
+    return (e.isPending() && e.generation == handle.generation) ? &e : nullptr;
+}
+
+const MidiMessageScheduler::Entry* MidiMessageScheduler::find(ScheduledMessageHandle handle) const {
+    return const_cast<MidiMessageScheduler*>(this)->find(handle);
+}
+
+void MidiMessageScheduler::link(uint32_t index) {
+    auto& e = entries[index];
+    auto bucket = bucketOf(linkedTick(e));
+    e.prev = NONE;
+    e.next = bucketHeads[bucket];
+    if (e.next != NONE) {
+        entries[e.next].prev = index;
+    }
+    bucketHeads[bucket] = index;
+    occupiedBuckets[bucket / 64] |= (uint64_t{1} << (bucket % 64));
 }
 
-void MidiMessageScheduler::sendOverdueMessages(double currentTimeMs, juce::MidiOutput& output) {
-    while (!queue.empty() && queue.top().sendTimeMs <= currentTimeMs) {
-        output.sendMessageNow(queue.top().message);
-        queue.pop();
+void MidiMessageScheduler::unlink(uint32_t index) {
+    auto& e = entries[index];
+    auto bucket = bucketOf(linkedTick(e));
+    if (e.prev != NONE) {
+        entries[e.prev].next = e.next;
+    } else {
+        bucketHeads[bucket] = e.next;
     }
+    if (e.next != NONE) {
+        entries[e.next].prev = e.prev;
+    }
+    if (bucketHeads[bucket] == NONE) {
+        occupiedBuckets[bucket / 64] &= ~(uint64_t{1} << (bucket % 64));
+    }
+    e.prev = NONE;
+    e.next = NONE;
+}
+
+void MidiMessageScheduler::release(uint32_t index) {
+    auto& e = entries[index];
+    ++e.generation;
+    e.next = freeHead;
+    freeHead = index;
+    --numPending;
 }
 
-void MidiMessageScheduler::clear() { queue = {}; }
+size_t MidiMessageScheduler::nextOccupiedBucket(size_t from, size_t maxDistance) const {
+    size_t distance = 0;
+    while (distance < maxDistance) {
+        auto bucket = (from + distance) & BUCKET_MASK;
+        auto bit = bucket % 64;
+        auto bits = occupiedBuckets[bucket / 64] >> bit;
+        if (bits != 0) {
+            return std::min(distance + static_cast<size_t>(std::countr_zero(bits)), maxDistance);
+        }
+        distance += 64 - bit;
+    }
+    return maxDistance;
+}
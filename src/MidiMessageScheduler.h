@@ -1,39 +1,111 @@
 #pragma once
 
-#include <juce_audio_basics/juce_audio_basics.h>
-#include <juce_audio_devices/juce_audio_devices.h>
-
-#include <queue>
+#include <algorithm>
+#include <cstdint>
+#include <optional>
 #include <vector>
 
-struct ScheduledMidiMessage {
-    double sendTimeMs;
-    juce::MidiMessage message;
+#include "Clock.h"
+#include "LatencyHistogram.h"
+#include "MidiEvent.h"
+#include "MidiSink.h"
+
+// Refers to a message scheduled with MidiMessageScheduler.
+// Goes stale (and is safely rejected) once the message is sent, cancelled or cleared.
+struct ScheduledMessageHandle {
+    static constexpr uint32_t INVALID_SLOT = UINT32_MAX;
+
+    uint32_t slot = INVALID_SLOT;
+    uint32_t generation = 0;
 
-    // Comparison for priority queue (min-heap: earliest time first)
-    bool operator>(const ScheduledMidiMessage& other) const { return sendTimeMs > other.sendTimeMs; }
+    bool isValid() const { return slot != INVALID_SLOT; }
 };
 
 /*
  * Schedules MIDI messages for delayed delivery.
  *
- * All times are in milliseconds.
- * Use juce::Time::getMillisecondCounterHiRes() for currentTimeMs.
+ * A hashed timing wheel with 1ms buckets over a preallocated pool of entries:
+ * schedule, reschedule, cancel and expiry are all O(1) and never allocate.
+ * Messages are sent in bucket order, so messages due in the same millisecond
+ * may go out in any order.
+ *
+ * All times are engine time in nanoseconds, see Clock.h.
+ * The scheduler never reads a clock itself, callers pass the current time in.
  */
 class MidiMessageScheduler {
    public:
-    MidiMessageScheduler() = default;
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+    explicit MidiMessageScheduler(size_t capacity = DEFAULT_CAPACITY);
 
-    void schedule(const juce::MidiMessage& msg, double currentTimeMs, double delayMs);
+    // Returns an invalid handle (and drops the message) if all entries are in use
+    ScheduledMessageHandle schedule(MidiEvent event, TimeNs currentTime, TimeNs delay);
 
-    void sendOverdueMessages(double currentTimeMs, juce::MidiOutput& output);
+    // Moves a pending message to a new send time. Returns false if it was already sent or cancelled.
+    bool reschedule(ScheduledMessageHandle handle, TimeNs sendTime);
+
+    // Returns false if the message was already sent or cancelled
+    bool cancel(ScheduledMessageHandle handle);
+
+    bool isPending(ScheduledMessageHandle handle) const;
+
+    // Sends every message due at or before currentTime, passing on its scheduled send time
+    void sendOverdueMessages(TimeNs currentTime, MidiSink& sink);
 
     void clear();
 
-    bool isEmpty() const { return queue.empty(); }
+    bool isEmpty() const { return numPending == 0; }
+
+    size_t size() const { return numPending; }
 
-    size_t size() const { return queue.size(); }
+    // Messages dropped because the pool was full
+    uint64_t getNumDropped() const { return numDropped; }
+
+    // Send time of the earliest pending message, if any
+    std::optional<TimeNs> nextSendTime() const;
+
+    // If set, sendOverdueMessages() records how late each message goes out (currentTime - send time).
+    // Recorded on the thread calling sendOverdueMessages(), so the histogram must outlive the scheduler's use of it.
+    void setLatenessHistogram(LatencyHistogram* histogram) { latenessHistogram = histogram; }
 
    private:
-    std::priority_queue<ScheduledMidiMessage, std::vector<ScheduledMidiMessage>, std::greater<ScheduledMidiMessage>> queue;
+    static constexpr uint32_t NONE = UINT32_MAX;
+    static constexpr size_t NUM_BUCKETS = 4096;  // must be a power of two, and cover the longest usual delay
+    static constexpr size_t BUCKET_MASK = NUM_BUCKETS - 1;
+
+    struct Entry {
+        TimeNs sendTime = 0;
+        MidiEvent event;
+        uint32_t next = NONE;
+        uint32_t prev = NONE;
+        uint32_t generation = 0;  // odd while pending, bumped on schedule and release so old handles go stale
+
+        bool isPending() const { return (generation & 1) != 0; }
+    };
+    static_assert(sizeof(Entry) == 24);
+
+    std::vector<Entry> entries;
+    std::vector<uint32_t> bucketHeads;
+    std::vector<uint64_t> occupiedBuckets;  // one bit per bucket, to skip empty ones quickly
+    uint32_t freeHead = NONE;
+    size_t numPending = 0;
+    uint64_t numDropped = 0;
+    LatencyHistogram* latenessHistogram = nullptr;
+
+    // Every tick before this has been fully processed
+    int64_t nextTick = 0;
+
+    static int64_t tickOf(TimeNs time) { return time / NS_PER_MS; }
+    static size_t bucketOf(int64_t tick) { return static_cast<size_t>(tick) & BUCKET_MASK; }
+    // The tick whose bucket a pending entry is in. Anything already overdue when linked goes in nextTick's bucket,
+    // so it isn't skipped. This is the same at unlink as at link: sendOverdueMessages() sends everything due
+    // before the ticks it moves past, so nextTick never passes an entry that's still pending.
+    int64_t linkedTick(const Entry& e) const { return std::max(tickOf(e.sendTime), nextTick); }
+
+    Entry* find(ScheduledMessageHandle handle);
+    const Entry* find(ScheduledMessageHandle handle) const;
+    void link(uint32_t index);
+    void unlink(uint32_t index);
+    void release(uint32_t index);
+    size_t nextOccupiedBucket(size_t from, size_t maxDistance) const;
 };
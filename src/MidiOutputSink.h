@@ -0,0 +1,18 @@
+#pragma once
+
+#include <juce_audio_devices/juce_audio_devices.h>
+
+#include "MidiSink.h"
+
+// Sends engine output straight to a MIDI output port, ignoring the intended time
+class MidiOutputSink : public MidiSink {
+   public:
+    explicit MidiOutputSink(juce::MidiOutput* output = nullptr) : output(output) {}
+
+    void setOutput(juce::MidiOutput* newOutput) { output = newOutput; }
+
+    void send(MidiEvent event, TimeNs) override { output->sendMessageNow(event.toMidiMessage()); }
+
+   private:
+    juce::MidiOutput* output;
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Clock.h"
+#include "MidiEvent.h"
+
+/*
+ * Destination for MIDI produced by the engine.
+ *
+ * Implementations are called on the engine thread, so must not block or allocate.
+ */
+class MidiSink {
+   public:
+    virtual ~MidiSink() = default;
+
+    // timeNs is when the event is meant to happen, in engine time
+    virtual void send(MidiEvent event, TimeNs timeNs) = 0;
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+/*
+ * Bounded multi-producer / single-consumer queue (Vyukov's bounded queue).
+ *
+ * Storage is preallocated, and push / pop never lock or allocate. Any number of threads may push,
+ * exactly one thread may pop at any given time. Each slot carries a sequence number, so producers
+ * only contend on the write index and never wait on each other.
+ */
+template <typename T, size_t Capacity>
+class MpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>, "MpscQueue elements are copied without locks, so must be trivially copyable");
+
+   public:
+    MpscQueue() {
+        for (size_t i = 0; i < Capacity; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Producer side, any thread. Returns false (and drops the item) if the queue is full.
+    bool push(const T& item) {
+        auto pos = writeIndex.load(std::memory_order_relaxed);
+        for (;;) {
+            auto& slot = slots[pos & MASK];
+            auto sequence = slot.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (writeIndex.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = item;
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // full
+            } else {
+                pos = writeIndex.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Consumer side. Returns false if the queue is empty (or the next item is still being written).
+    bool pop(T& item) {
+        auto& slot = slots[readIndex & MASK];
+        if (slot.sequence.load(std::memory_order_acquire) != readIndex + 1) {
+            return false;
+        }
+        item = slot.value;
+        slot.sequence.store(readIndex + Capacity, std::memory_order_release);
+        ++readIndex;
+        return true;
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+   private:
+    static constexpr size_t MASK = Capacity - 1;
+    static constexpr size_t CACHE_LINE = 64;
+
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        T value{};
+    };
+
+    alignas(CACHE_LINE) std::atomic<size_t> writeIndex{0};
+    alignas(CACHE_LINE) size_t readIndex = 0;  // consumer only
+    alignas(CACHE_LINE) std::array<Slot, Capacity> slots{};
+};
@@ -2,11 +2,21 @@
 
 #include <juce_core/juce_core.h>
 
-#include <algorithm>
-#include <unordered_set>
+namespace {
 
-Omnify::Omnify(MidiMessageScheduler& scheduler, std::shared_ptr<OmnifySettings> settings, std::shared_ptr<RealtimeParams> realtimeParams)
-    : scheduler(scheduler), realtimeParams(std::move(realtimeParams)) {
+// Collects output for the single-message handle() wrapper
+class VectorSink : public MidiSink {
+   public:
+    std::vector<juce::MidiMessage> messages;
+
+    void send(MidiEvent event, TimeNs) override { messages.push_back(event.toMidiMessage()); }
+};
+
+}  // namespace
+
+Omnify::Omnify(MidiMessageScheduler& scheduler, std::shared_ptr<OmnifySettings> settings, std::shared_ptr<RealtimeParams> realtimeParams,
+               const MonotonicClock& clock)
+    : scheduler(scheduler), clock(clock), realtimeParams(std::move(realtimeParams)) {
     updateSettings(std::move(settings), true);
 }
 
@@ -15,244 +25,188 @@ void Omnify::updateSettings(std::shared_ptr<OmnifySettings> newSettings, bool in
         realtimeParams->strumGateTimeMs.store(newSettings->strumGateTimeMs);
         realtimeParams->strumCooldownMs.store(newSettings->strumCooldownMs);
     }
-    std::atomic_store(&settings, std::move(newSettings));
-}
-
-void Omnify::syncRealtimeSettings() {
-    auto s = std::atomic_load(&settings);
-    s->strumGateTimeMs = realtimeParams->strumGateTimeMs.load();
-    s->strumCooldownMs = realtimeParams->strumCooldownMs.load();
+    // Compile voicings etc here on the calling (message) thread, never on the engine thread
+    compiled.publish(CompiledSettings::compile(std::move(newSettings)));
 }
 
-std::vector<juce::MidiMessage> Omnify::handle(const juce::MidiMessage& msg) {
-    auto s = std::atomic_load(&settings);
-    if (auto r = handleChordQualityChange(msg, *s)) {
-        return *r;
-    }
-    if (auto r = handleStopButton(msg, *s)) {
-        return *r;
-    }
-    if (auto r = handleLatchButton(msg, *s)) {
-        return *r;
+void Omnify::refreshStaleVoicings() {
+    auto current = compiled.current();
+    if (current && current->isStale()) {
+        compiled.publish(CompiledSettings::compile(current->settings));
     }
-    if (auto r = handleChordNoteOn(msg, *s)) {
-        return *r;
-    }
-    if (auto r = handleChordNoteOff(msg, *s)) {
-        return *r;
-    }
-    if (auto r = handleStrum(msg, *s)) {
-        return *r;
-    }
-    return {};
 }
 
-std::optional<std::vector<juce::MidiMessage>> Omnify::handleChordQualityChange(const juce::MidiMessage& msg, const OmnifySettings& s) {
-    std::optional<ChordQuality> quality;
-
-    std::visit(
-        [&](auto&& style) {
-            using T = std::decay_t<decltype(style)>;
-            if constexpr (std::is_same_v<T, ButtonPerChordQuality>) {
-                if (msg.isNoteOn() && msg.getVelocity() > 0) {
-                    auto it = style.notes.find(msg.getNoteNumber());
-                    if (it != style.notes.end()) {
-                        quality = it->second;
-                    }
-                } else if (msg.isController()) {
-                    auto it = style.ccs.find(msg.getControllerNumber());
-                    if (it != style.ccs.end() && msg.getControllerValue() > 63) {
-                        quality = it->second;
-                    }
-                }
-            } else if constexpr (std::is_same_v<T, CCRangePerChordQuality>) {
-                if (msg.isController() && msg.getControllerNumber() == style.cc) {
-                    int idx = (msg.getControllerValue() * 9) / 128;
-                    quality = ALL_CHORD_QUALITIES[static_cast<size_t>(idx)];
-                }
-            }
-        },
-        s.chordQualitySelectionStyle.value);
-
-    if (quality) {
-        enqueuedChordQuality = *quality;
-        return std::vector<juce::MidiMessage>{};
+void Omnify::process(std::span<const TimestampedMidiEvent> events, MidiSink& out) {
+    if (events.empty()) {
+        return;
+    }
+    // One snapshot per batch, no refcounting
+    SnapshotPublisher<CompiledSettings>::ReadScope c(compiled);
+    for (const auto& event : events) {
+        handleMessage(event, *c, out);
     }
-    return std::nullopt;
 }
 
-std::optional<std::vector<juce::MidiMessage>> Omnify::handleStopButton(const juce::MidiMessage& msg, const OmnifySettings& s) {
-    if (s.stopButton.handle(msg)) {
-        return stopNotesOfCurrentChord();
-    }
-    return std::nullopt;
+std::vector<juce::MidiMessage> Omnify::handle(const juce::MidiMessage& msg) {
+    // A lone message has no arrival time to go on, so treat it as arriving now
+    TimestampedMidiEvent event;
+    if (!TimestampedMidiEvent::fromMidiMessage(msg, clock.now(), event)) {
+        return {};
+    }
+    VectorSink sink;
+    process(std::span(&event, 1), sink);
+    return std::move(sink.messages);
 }
 
-std::optional<std::vector<juce::MidiMessage>> Omnify::handleLatchButton(const juce::MidiMessage& msg, const OmnifySettings& s) {
-    auto action = s.latchButton.handle(msg);
-    if (!action) {
-        return std::nullopt;
-    }
+void Omnify::handleMessage(const TimestampedMidiEvent& event, const CompiledSettings& c, MidiSink& out) {
+    auto data1 = event.midi.bytes[1];
+    auto data2 = event.midi.bytes[2];
+    const auto& route = c.inputRoutes.lookup(event.midi.bytes[0], data1, data2);
 
-    switch (*action) {
-        case ButtonAction::ON:
-            latch = true;
+    switch (route.actionFor(data2)) {
+        case InputAction::NONE:
             break;
-        case ButtonAction::OFF:
-            latch = false;
+        case InputAction::CHORD_QUALITY:
+            enqueuedChordQuality = route.quality;
             break;
-        case ButtonAction::FLIP:
-            latch = !latch;
+        case InputAction::CHORD_QUALITY_RANGE:
+            handleChordQualityRange(data2);
             break;
-    }
-
-    if (!latch) {
-        return stopNotesOfCurrentChord();
-    }
-    return std::vector<juce::MidiMessage>{};
-}
-
-std::optional<std::vector<juce::MidiMessage>> Omnify::handleChordNoteOn(const juce::MidiMessage& msg, const OmnifySettings& s) {
-    if (!msg.isNoteOn() || msg.getVelocity() == 0) {
-        return std::nullopt;
-    }
-
-    auto events = stopNotesOfCurrentChord();
-
-    currentChord = Chord{enqueuedChordQuality, msg.getNoteNumber()};
-
-    std::unordered_set<int> clampedNotes;
-
-    std::vector<int> chord;
-
-    switch (s.voicingModifier) {
-        case VoicingModifier::NONE:
-            chord = s.chordVoicingStyle->constructChord(currentChord->quality, currentChord->root);
+        case InputAction::STOP:
+            stopNotesOfCurrentChord(event.timeNs, out);
             break;
-        case VoicingModifier::FIXED:
-            chord = s.chordVoicingStyle->constructChord(currentChord->quality, 60 + (currentChord->root % 12));
+        case InputAction::LATCH:
+            handleLatchButton(route, data2, event.timeNs, out);
             break;
-        case VoicingModifier::SMOOTH:
-            auto normalizedRoot = 60 + (currentChord->root % 12);
-            auto middleOctaveNotes = s.chordVoicingStyle->constructChord(currentChord->quality, normalizedRoot);
-            std::vector<int> offsets;
-            offsets.reserve(middleOctaveNotes.size());
-            for (int x : middleOctaveNotes) {
-                offsets.push_back(x - 60);
-            }
-            chord = smooth(offsets, currentChord->root);
+        case InputAction::CHORD_NOTE_ON:
+            handleChordNoteOn(data1, data2, event.timeNs, c, out);
+            break;
+        case InputAction::CHORD_NOTE_OFF:
+            handleChordNoteOff(data1, event.timeNs, out);
+            break;
+        case InputAction::STRUM:
+            handleStrum(data2, event.timeNs, c, out);
+            break;
+        case InputAction::ALL_NOTES_OFF:
+            handleAllNotesOff(event.timeNs, c, out);
             break;
     }
+}
 
-    for (int note : chord) {
-        int clamped = clampNote(note);
-        if (clampedNotes.contains(clamped)) {
-            continue;
-        }
-        clampedNotes.insert(clamped);
-
-        auto on = juce::MidiMessage::noteOn(s.chordChannel, clamped, msg.getVelocity());
-        events.push_back(on);
-        noteOnEventsOfCurrentChord.push_back(on);
-    }
-
-    return events;
+void Omnify::handleChordQualityRange(int ccValue) {
+    int idx = (ccValue * 9) / 128;
+    enqueuedChordQuality = ALL_CHORD_QUALITIES[static_cast<size_t>(idx)];
 }
 
-std::optional<std::vector<juce::MidiMessage>> Omnify::handleChordNoteOff(const juce::MidiMessage& msg, const OmnifySettings& s) {
-    bool isNoteOff = msg.isNoteOff() || (msg.isNoteOn() && msg.getVelocity() == 0);
-    if (!isNoteOff) {
-        return std::nullopt;
+void Omnify::handleLatchButton(const InputRoute& route, int value, TimeNs timeNs, MidiSink& out) {
+    // Notes and momentary CCs flip latch, toggle CCs set it
+    latch = route.toggle ? value > 63 : !latch;
+
+    if (!latch) {
+        stopNotesOfCurrentChord(timeNs, out);
     }
+}
 
-    if (currentChord && currentChord->root == msg.getNoteNumber() && !latch) {
-        return stopNotesOfCurrentChord();
+void Omnify::handleChordNoteOn(int note, juce::uint8 velocity, TimeNs timeNs, const CompiledSettings& c, MidiSink& out) {
+    auto channel = c.settings->chordChannel;
+    currentChord = Chord{enqueuedChordQuality, note};
+    currentChordVelocity = velocity;
+    currentStrumVoicing = c.strumVoicings.lookup(currentChord->quality, currentChord->root);
+
+    // Already clamped and transformed by the voicing modifier
+    NoteSet next;
+    for (auto chordNote : c.chordVoicings.lookup(currentChord->quality, currentChord->root).view()) {
+        next.set(chordNote);
+    }
+
+    // Legato: release only the notes the new chord drops and start only the ones it adds, shared notes keep sounding.
+    // Notes left on another channel (the chord channel changed) are all released.
+    chordNotes.forEachChannel([&](int ch, const NoteSet& notes) {
+        (ch == channel ? notes.without(next) : notes).forEach([&](int n) { out.send(MidiEvent::noteOff(ch, n), timeNs); });
+    });
+
+    // Strummed notes still ringing on this channel are already sounding, so the chord takes them over as they are:
+    // no second note-on, and their pending note-off is cancelled so it can't cut the chord
+    NoteSet sounding = chordNotes.on(channel);
+    if (c.settings->strumChannel == channel) {
+        next.forEach([&](int n) {
+            if (auto& pending = strumNoteOffs[static_cast<size_t>(n)];
+                pending.channel == channel && scheduler.cancel(pending.handle)) {
+                sounding.set(n);
+            }
+        });
     }
+    next.without(sounding).forEach([&](int n) { out.send(MidiEvent::noteOn(channel, n, velocity), timeNs); });
 
-    return std::nullopt;
+    chordNotes.clear();
+    chordNotes.set(channel, next);
 }
 
-std::optional<std::vector<juce::MidiMessage>> Omnify::handleStrum(const juce::MidiMessage& msg, const OmnifySettings& s) {
-    if (!(msg.isController() && msg.getControllerNumber() == s.strumPlateCC)) {
-        return std::nullopt;
+void Omnify::handleChordNoteOff(int note, TimeNs timeNs, MidiSink& out) {
+    if (currentChord && currentChord->root == note && !latch) {
+        stopNotesOfCurrentChord(timeNs, out);
     }
+}
 
+void Omnify::handleStrum(int ccValue, TimeNs timeNs, const CompiledSettings& c, MidiSink& out) {
+    const auto& s = *c.settings;
     if (!currentChord) {
         // TODO: Should strums be allowed if no chord is playing?
         // TODO: (use previous chord?)
-        return std::vector<juce::MidiMessage>{};
+        return;
     }
 
-    double now = juce::Time::getMillisecondCounterHiRes();
-    bool cooldownReady = now >= lastStrumTimeMs + realtimeParams->strumCooldownMs.load();
+    // Measure cooldown and gate from when the strum arrived, not from when we got round to processing it
+    auto now = timeNs;
+    bool cooldownReady = now >= lastStrumTime + msToNs(realtimeParams->strumCooldownMs.load());
 
-    int strumPlateZone = (msg.getControllerValue() * 13) / 128;
+    int strumPlateZone = (ccValue * 13) / 128;
 
     if (lastStrumZone != strumPlateZone || cooldownReady) {
-        auto velocity = noteOnEventsOfCurrentChord[0].getVelocity();
+        auto strumChord = currentStrumVoicing.view();
+        if (!chordNotes.any() || static_cast<size_t>(strumPlateZone) >= strumChord.size()) {
+            return;  // nothing to strum, eg this chord failed to compile
+        }
 
-        auto strumChord = s.strumVoicingStyle->constructChord(currentChord->quality, currentChord->root);
+        auto velocity = currentChordVelocity;
         int noteToPlay = strumChord[static_cast<size_t>(strumPlateZone)];
 
-        auto noteOn = juce::MidiMessage::noteOn(s.strumChannel, noteToPlay, velocity);
-
-        scheduler.schedule(juce::MidiMessage::noteOff(s.strumChannel, noteToPlay), now, static_cast<double>(realtimeParams->strumGateTimeMs.load()));
-
-        lastStrumTimeMs = now;
+        lastStrumTime = now;
         lastStrumZone = strumPlateZone;
 
-        return std::vector<juce::MidiMessage>{noteOn};
-    }
+        // Already sounding as part of the chord on this channel, and a note-off would cut it while the chord is held
+        if (chordNotes.on(s.strumChannel).test(noteToPlay)) {
+            return;
+        }
 
-    return std::vector<juce::MidiMessage>{};
-}
+        auto noteOn = MidiEvent::noteOn(s.strumChannel, noteToPlay, velocity);
 
-std::vector<juce::MidiMessage> Omnify::stopNotesOfCurrentChord() {
-    currentChord = std::nullopt;
+        auto gate = msToNs(realtimeParams->strumGateTimeMs.load());
+        auto& pending = strumNoteOffs[static_cast<size_t>(noteToPlay)];
+        if (pending.channel != s.strumChannel || !scheduler.reschedule(pending.handle, now + gate)) {
+            pending.handle = scheduler.schedule(MidiEvent::noteOff(s.strumChannel, noteToPlay), now, gate);
+            pending.channel = s.strumChannel;
+        }
 
-    std::vector<juce::MidiMessage> events;
-    events.reserve(noteOnEventsOfCurrentChord.size());
-    for (const auto& noteOn : noteOnEventsOfCurrentChord) {
-        events.push_back(juce::MidiMessage::noteOff(noteOn.getChannel(), noteOn.getNoteNumber()));
+        out.send(noteOn, timeNs);
     }
-    noteOnEventsOfCurrentChord.clear();
-    return events;
 }
 
-int Omnify::clampNote(int note) { return std::clamp(note, 0, 127); }
-
-std::vector<int> Omnify::smooth(std::vector<int> offsets, int root) {
-    std::sort(offsets.begin(), offsets.end());
-    auto octave = root / 12;
-    auto pitchClass = root % 12;
-    std::vector<int> notes;
-    notes.reserve(offsets.size());
-
-    std::vector<int> inversionOffsets(offsets.size(), 0);
+void Omnify::handleAllNotesOff(TimeNs timeNs, const CompiledSettings& c, MidiSink& out) {
+    currentChord = std::nullopt;
 
-    switch (octave) {
-        case 3:
-            inversionOffsets[inversionOffsets.size() - 2] = -12;
-            inversionOffsets[inversionOffsets.size() - 1] = -12;
-            break;
-        case 4:
-            inversionOffsets[inversionOffsets.size() - 1] = -12;
-            break;
-        // case 5: middle octave, do nothing
-        case 6:
-            inversionOffsets[0] = 12;
-            break;
-        case 7:
-            inversionOffsets[0] = 12;
-            inversionOffsets[1] = 12;
-            break;
-        default:
-            break;
+    // One message per channel rather than one per note. The strum channel too, for strummed notes still ringing.
+    auto strumChannel = c.settings->strumChannel;
+    chordNotes.forEachChannel([&](int ch, const NoteSet&) { out.send(MidiEvent::allNotesOff(ch), timeNs); });
+    if (!chordNotes.on(strumChannel).any()) {
+        out.send(MidiEvent::allNotesOff(strumChannel), timeNs);
     }
+    chordNotes.clear();
+}
 
-    for (size_t i = 0; i < offsets.size(); i++) {
-        notes.push_back(60 + pitchClass + offsets[i] + inversionOffsets[i]);
-    }
+void Omnify::stopNotesOfCurrentChord(TimeNs timeNs, MidiSink& out) {
+    currentChord = std::nullopt;
 
-    return notes;
-}
\ No newline at end of file
+    chordNotes.forEachChannel([&](int ch, const NoteSet& notes) { notes.forEach([&](int n) { out.send(MidiEvent::noteOff(ch, n), timeNs); }); });
+    chordNotes.clear();
+}
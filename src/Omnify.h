@@ -2,12 +2,21 @@
 
 #include <juce_audio_basics/juce_audio_basics.h>
 
+#include <array>
 #include <atomic>
 #include <memory>
 #include <optional>
+#include <span>
 #include <vector>
 
+#include "ActiveNotes.h"
+#include "Clock.h"
+#include "CompiledSettings.h"
+#include "MidiEvent.h"
 #include "MidiMessageScheduler.h"
+#include "MidiSink.h"
+#include "SnapshotPublisher.h"
+#include "TimestampedMidiEvent.h"
 #include "datamodel/ChordQuality.h"
 #include "datamodel/MidiButton.h"
 #include "datamodel/OmnifySettings.h"
@@ -19,34 +28,57 @@ struct RealtimeParams {
 
 class Omnify {
    public:
-    Omnify(MidiMessageScheduler& scheduler, std::shared_ptr<OmnifySettings> settings, std::shared_ptr<RealtimeParams> realtimeParams);
+    // The clock is only read by handle(); process() takes its times from the events
+    Omnify(MidiMessageScheduler& scheduler, std::shared_ptr<OmnifySettings> settings, std::shared_ptr<RealtimeParams> realtimeParams,
+           const MonotonicClock& clock = SystemClock::instance());
 
+    // Processes a batch of input events in order, sending everything they produce to out.
+    // Loads settings once per batch and doesn't allocate, so it's safe on the realtime thread.
+    // Event times drive strum cooldowns and gate lengths, so they should be arrival times, not processing times.
+    void process(std::span<const TimestampedMidiEvent> events, MidiSink& out);
+
+    // Convenience wrapper around process() for a single message
     std::vector<juce::MidiMessage> handle(const juce::MidiMessage& msg);
 
+    // Message thread only. Compiles and publishes a new settings snapshot, the engine picks it up on its next batch.
     void updateSettings(std::shared_ptr<OmnifySettings> newSettings, bool includeRealtime = false);
-    void syncRealtimeSettings();
+    // Message thread only. Frees settings snapshots the engine has finished with, call periodically.
+    void reclaimRetiredSettings() { compiled.reclaim(); }
+    // Message thread only. Recompiles voicings if a voicing style's data has changed (eg a chord file loaded), call periodically.
+    void refreshStaleVoicings();
 
    private:
     MidiMessageScheduler& scheduler;
-    std::shared_ptr<OmnifySettings> settings;  // use std::atomic_load/store for thread safety
+    const MonotonicClock& clock;
+    SnapshotPublisher<CompiledSettings> compiled;
     std::shared_ptr<RealtimeParams> realtimeParams;
 
     // State
     ChordQuality enqueuedChordQuality = ChordQuality::MAJOR;
     std::optional<Chord> currentChord;
-    std::vector<juce::MidiMessage> noteOnEventsOfCurrentChord;
-    double lastStrumTimeMs = 0;
+    ActiveNotes chordNotes;  // sounding chord notes, per output channel
+    // Strum voicing of the current chord, captured with it so new voicings (eg a chord file reload) wait for the next chord
+    CompiledVoicing<NUM_STRUM_ZONES> currentStrumVoicing;
+    juce::uint8 currentChordVelocity = 0;
+    TimeNs lastStrumTime = 0;
     std::optional<int> lastStrumZone;
+
+    // The pending note-off for each strummed note, so restrumming a sounding note extends its gate
+    struct PendingNoteOff {
+        ScheduledMessageHandle handle;
+        int channel = 0;
+    };
+    std::array<PendingNoteOff, 128> strumNoteOffs;
     bool latch = false;
 
-    std::optional<std::vector<juce::MidiMessage>> handleChordQualityChange(const juce::MidiMessage& msg, const OmnifySettings& s);
-    std::optional<std::vector<juce::MidiMessage>> handleStopButton(const juce::MidiMessage& msg, const OmnifySettings& s);
-    std::optional<std::vector<juce::MidiMessage>> handleLatchButton(const juce::MidiMessage& msg, const OmnifySettings& s);
-    std::optional<std::vector<juce::MidiMessage>> handleChordNoteOn(const juce::MidiMessage& msg, const OmnifySettings& s);
-    std::optional<std::vector<juce::MidiMessage>> handleChordNoteOff(const juce::MidiMessage& msg, const OmnifySettings& s);
-    std::optional<std::vector<juce::MidiMessage>> handleStrum(const juce::MidiMessage& msg, const OmnifySettings& s);
+    // Looks the message up in the compiled routing table and runs the one handler it's routed to
+    void handleMessage(const TimestampedMidiEvent& event, const CompiledSettings& c, MidiSink& out);
+    void handleChordQualityRange(int ccValue);
+    void handleLatchButton(const InputRoute& route, int value, TimeNs timeNs, MidiSink& out);
+    void handleChordNoteOn(int note, juce::uint8 velocity, TimeNs timeNs, const CompiledSettings& c, MidiSink& out);
+    void handleChordNoteOff(int note, TimeNs timeNs, MidiSink& out);
+    void handleStrum(int ccValue, TimeNs timeNs, const CompiledSettings& c, MidiSink& out);
+    void handleAllNotesOff(TimeNs timeNs, const CompiledSettings& c, MidiSink& out);
 
-    std::vector<juce::MidiMessage> stopNotesOfCurrentChord();
-    static int clampNote(int note);
-    static std::vector<int> smooth(std::vector<int> offsets, int root);
+    void stopNotesOfCurrentChord(TimeNs timeNs, MidiSink& out);
 };
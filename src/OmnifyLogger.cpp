@@ -1,10 +1,12 @@
 #include "OmnifyLogger.h"
 
+#include <algorithm>
+
 #if JUCE_MAC || JUCE_LINUX
 #include <unistd.h>  // for confstr
 #endif
 
-OmnifyLogger::OmnifyLogger() {
+OmnifyLogger::OmnifyLogger() : juce::Thread("OmnifyLogger") {
     auto systemTempDir = getSystemTempDir();
 
     // Create a unique session directory: omnify-<uuid>/
@@ -18,9 +20,13 @@ OmnifyLogger::OmnifyLogger() {
 
     // Set as current logger so Logger::writeToLog works
     juce::Logger::setCurrentLogger(logger.get());
+
+    startThread();
 }
 
 OmnifyLogger::~OmnifyLogger() {
+    stopThread(1000);
+    flushRealtimeRecords();
     juce::Logger::setCurrentLogger(nullptr);
 }
 
@@ -30,6 +36,36 @@ void OmnifyLogger::log(const juce::String& message) {
     }
 }
 
+void OmnifyLogger::run() {
+    auto intervalMs = MIN_FLUSH_INTERVAL_MS;
+    while (!threadShouldExit()) {
+        // Idle, the thread wakes about once a second rather than 20 times
+        intervalMs = flushRealtimeRecords() ? MIN_FLUSH_INTERVAL_MS : std::min(intervalMs * 2, MAX_FLUSH_INTERVAL_MS);
+        wait(intervalMs);
+    }
+}
+
+bool OmnifyLogger::flushRealtimeRecords() {
+    if (!logger) {
+        return false;
+    }
+
+    bool wroteAny = false;
+    LogRecord record;
+    while (realtimeRecords.pop(record)) {
+        logger->logMessage("[" + juce::String(nsToMs(record.timeNs), 3) + " ms] " + juce::String(record.text.data()));
+        wroteAny = true;
+    }
+
+    auto dropped = droppedRecords.load(std::memory_order_relaxed);
+    if (dropped != reportedDroppedRecords) {
+        logger->logMessage(juce::String(dropped - reportedDroppedRecords) + " realtime log records dropped, log ring was full");
+        reportedDroppedRecords = dropped;
+        wroteAny = true;
+    }
+    return wroteAny;
+}
+
 juce::String OmnifyLogger::getSystemTempDir() {
 #if JUCE_MAC
     // Use confstr to get _CS_DARWIN_USER_TEMP_DIR (/var/folders/.../T)
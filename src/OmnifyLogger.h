@@ -2,27 +2,76 @@
 
 #include <juce_core/juce_core.h>
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+
+#include "Clock.h"
+#include "MpscQueue.h"
+
 /**
  * Shared logging and temp directory for Omnify plugin.
  * Creates a unique session directory under the system temp dir.
  *
  * Use via juce::SharedResourcePointer<OmnifyLogger> to ensure proper cleanup.
  */
-class OmnifyLogger {
+class OmnifyLogger : private juce::Thread {
    public:
     OmnifyLogger();
-    ~OmnifyLogger();
+    ~OmnifyLogger() override;
 
     juce::File getTempDir() const { return sessionTempDir; }
 
-    // Logs via OmnifyLogger directly
+    // Logs via OmnifyLogger directly. Locks and does file I/O, so not for realtime threads.
     void log(const juce::String& message);
 
+    // Realtime-safe: formats into a fixed-size record and pushes it onto a lock-free ring, never locking or allocating.
+    // A background thread writes records to the log. Text past MAX_RECORD_LENGTH is truncated,
+    // and records that don't fit in the ring are dropped and counted.
+    template <typename... Args>
+    void logRealtime(const char* format, Args... args) {
+        LogRecord record;
+        record.timeNs = SystemClock::instance().now();
+        if constexpr (sizeof...(Args) == 0) {
+            std::snprintf(record.text.data(), record.text.size(), "%s", format);
+        } else if (std::snprintf(record.text.data(), record.text.size(), format, args...) < 0) {
+            return;
+        }
+        if (!realtimeRecords.push(record)) {
+            droppedRecords.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Realtime records dropped because the ring was full
+    uint64_t getDroppedRecordCount() const { return droppedRecords.load(std::memory_order_relaxed); }
+
     // Also sets itself as juce::Logger::currentLogger, so Logger::writeToLog() works too
 
    private:
+    static constexpr size_t MAX_RECORD_LENGTH = 200;
+    static constexpr size_t RING_CAPACITY = 256;
+    // The writer flushes every MIN_FLUSH_INTERVAL_MS while records are arriving,
+    // backing off to MAX_FLUSH_INTERVAL_MS while the ring stays empty
+    static constexpr int MIN_FLUSH_INTERVAL_MS = 50;
+    static constexpr int MAX_FLUSH_INTERVAL_MS = 1000;
+
+    struct LogRecord {
+        TimeNs timeNs = 0;
+        std::array<char, MAX_RECORD_LENGTH + 1> text{};
+    };
+
     juce::File sessionTempDir;
     std::unique_ptr<juce::FileLogger> logger;
 
+    MpscQueue<LogRecord, RING_CAPACITY> realtimeRecords;
+    std::atomic<uint64_t> droppedRecords{0};
+    uint64_t reportedDroppedRecords = 0;  // writer thread only
+
+    // Writer thread: polls rather than being notified, since waking a thread isn't realtime-safe
+    void run() override;
+    // Returns whether anything was written
+    bool flushRealtimeRecords();
+
     static juce::String getSystemTempDir();
 };
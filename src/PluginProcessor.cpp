@@ -1,15 +1,11 @@
 #include "PluginProcessor.h"
 
+#include <cmath>
 #include <nlohmann/json.hpp>
 
 #include "BinaryData.h"
 #include "PluginEditor.h"
-#include "voicing_styles/FromFile.h"
-#include "voicing_styles/Omni84.h"
-#include "voicing_styles/OmnichordChords.h"
-#include "voicing_styles/OmnichordStrum.h"
-#include "voicing_styles/PlainAscending.h"
-#include "voicing_styles/RootPosition.h"
+#include "voicing_styles/BuiltinVoicingStyles.h"
 
 namespace {
 // Create the minimal APVTS layout with just 2 realtime params
@@ -29,25 +25,27 @@ juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout(juce::
 
     return layout;
 }
-}  // namespace
-
-void OmnifyAudioProcessor::initVoicingRegistries() {
-    chordVoicingRegistry.registerStyle("RootPosition", std::make_shared<RootPosition>(), RootPosition::from_json);
-    chordVoicingRegistry.registerStyle("FromFile", std::make_shared<FromFile<VoicingFor::Chord>>(""), FromFile<VoicingFor::Chord>::from_json);
-    chordVoicingRegistry.registerStyle("Omnichord", std::make_shared<OmnichordChords>(), OmnichordChords::from_json);
 
-    chordVoicingRegistry.registerStyle("Omni84", std::make_shared<Omni84>(), Omni84::from_json);
-
-    strumVoicingRegistry.registerStyle("PlainAscending", std::make_shared<PlainAscending>(), PlainAscending::from_json);
-    strumVoicingRegistry.registerStyle("Omnichord", std::make_shared<OmnichordStrum>(), OmnichordStrum::from_json);
+juce::AudioProcessor::BusesProperties createBusesProperties() {
+#if JucePlugin_IsMidiEffect
+    // MIDI in, MIDI out, nothing to do with audio
+    return {};
+#else
+    return juce::AudioProcessor::BusesProperties()
+        .withInput("Input", juce::AudioChannelSet::stereo(), true)
+        .withOutput("Output", juce::AudioChannelSet::stereo(), true);
+#endif
 }
 
+// Bytes reserved for one block's output, so the output buffer doesn't grow on the audio thread
+constexpr size_t HOST_MIDI_OUT_RESERVE_BYTES = 16384;
+}  // namespace
+
 OmnifyAudioProcessor::OmnifyAudioProcessor()
-    : AudioProcessor(
-          BusesProperties().withInput("Input", juce::AudioChannelSet::stereo(), true).withOutput("Output", juce::AudioChannelSet::stereo(), true)),
+    : AudioProcessor(createBusesProperties()),
       parameters(*this, nullptr, "PARAMETERS", createParameterLayout(strumGateTimeParam, strumCooldownParam)) {
     juce::LookAndFeel::setDefaultLookAndFeel(&lcarsLookAndFeel);
-    initVoicingRegistries();
+    registerBuiltinVoicingStyles(chordVoicingRegistry, strumVoicingRegistry);
 
     parameters.addParameterListener("strum_gate_time_ms", this);
     parameters.addParameterListener("strum_cooldown_ms", this);
@@ -58,7 +56,9 @@ OmnifyAudioProcessor::OmnifyAudioProcessor()
 
     omnify = std::make_unique<Omnify>(*midiScheduler, omnifySettings, realtimeParams);
     daemomnify = std::make_unique<Daemomnify>(*omnify, *midiScheduler, "Omnify");
-    daemomnify->start();
+    if (ENGINE_MODE == EngineMode::VirtualPort) {
+        daemomnify->start();
+    }
     startTimer(100);  // Check MIDI devices every 100ms
 
     loadDefaultSettings();
@@ -77,52 +77,102 @@ OmnifyAudioProcessor::~OmnifyAudioProcessor() {
     parameters.removeParameterListener("strum_cooldown_ms", this);
 }
 
-void OmnifyAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock) { juce::ignoreUnused(sampleRate, samplesPerBlock); }
+void OmnifyAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock) {
+    juce::ignoreUnused(samplesPerBlock);
+    hostSampleRate = sampleRate;
+    hostMidiOut.ensureSize(HOST_MIDI_OUT_RESERVE_BYTES);
+    resetHostClock();
+}
 
 void OmnifyAudioProcessor::releaseResources() {}
 
 void OmnifyAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) {
-    juce::ignoreUnused(buffer, midiMessages);
-}
+    // Audio (if there are any audio buses at all) passes through untouched
+    if (ENGINE_MODE != EngineMode::InHost) {
+        return;
+    }
 
-juce::AudioProcessorEditor* OmnifyAudioProcessor::createEditor() { return new OmnifyAudioProcessorEditor(*this); }
+    auto numSamples = buffer.getNumSamples();
+    auto blockStart = hostSampleTime(hostSamplePosition);
 
-void OmnifyAudioProcessor::getStateInformation(juce::MemoryBlock& destData) {
-    // Sync realtime params back to settings before saving
-    auto settings = std::atomic_load(&omnifySettings);
-    settings->strumGateTimeMs = realtimeParams->strumGateTimeMs.load();
-    settings->strumCooldownMs = realtimeParams->strumCooldownMs.load();
+    hostMidiOut.clear();
+    hostMidiSink.beginBlock(hostMidiOut, blockStart, hostSampleRate, numSamples);
+
+    for (const auto metadata : midiMessages) {
+        TimestampedMidiEvent event;
+        auto eventTime = hostSampleTime(hostSamplePosition + metadata.samplePosition);
+        if (!TimestampedMidiEvent::fromMidiMessage(metadata.getMessage(), eventTime, event)) {
+            continue;
+        }
+        // Scheduled messages due before this event go out first, in case it reschedules them
+        midiScheduler->sendOverdueMessages(eventTime, hostMidiSink);
+        omnify->process(std::span(&event, 1), hostMidiSink);
+    }
 
-    saveSettingsToValueTree();
+    // Anything due before the next block starts gets rendered at its exact sample in this one
+    auto nextBlockStart = hostSampleTime(hostSamplePosition + numSamples);
+    midiScheduler->sendOverdueMessages(nextBlockStart - 1, hostMidiSink);
 
-    // Combine APVTS state and our stateTree
-    juce::ValueTree combined{"OmnifyStateV1"};
-    combined.appendChild(parameters.copyState(), nullptr);
-    combined.appendChild(stateTree.createCopy(), nullptr);
+    // Copied rather than swapped, so hostMidiOut keeps the capacity reserved in prepareToPlay
+    midiMessages.clear();
+    midiMessages.addEvents(hostMidiOut, 0, numSamples, 0);
+    hostSamplePosition += numSamples;
+}
 
-    juce::MemoryOutputStream stream(destData, true);
-    combined.writeToStream(stream);
+void OmnifyAudioProcessor::resetHostClock() {
+    // Start the sample clock at the current engine time, so note-offs scheduled before a restart still line up
+    hostClockStart = SystemClock::instance().now();
+    hostSamplePosition = 0;
+}
+
+TimeNs OmnifyAudioProcessor::hostSampleTime(int64_t samplePosition) const {
+    // Round up, so converting back to a sample offset lands on this sample rather than the one before
+    auto ns = std::ceil(static_cast<double>(samplePosition) * 1e9 / hostSampleRate);
+    return hostClockStart + static_cast<TimeNs>(ns);
+}
+
+juce::AudioProcessorEditor* OmnifyAudioProcessor::createEditor() { return new OmnifyAudioProcessorEditor(*this); }
+
+void OmnifyAudioProcessor::getStateInformation(juce::MemoryBlock& destData) {
+    // Binary, so restoring doesn't need a JSON parse. The realtime params are the source of truth for the strum timings.
+    auto settings = *std::atomic_load(&omnifySettings);
+    settings.strumGateTimeMs = realtimeParams->strumGateTimeMs.load();
+    settings.strumCooldownMs = realtimeParams->strumCooldownMs.load();
+
+    juce::MemoryOutputStream stream(destData, false);
+    settings.to_binary(stream);
+    settingsSerializations.fetch_add(1, std::memory_order_relaxed);
 }
 
 void OmnifyAudioProcessor::setStateInformation(const void* data, int sizeInBytes) {
-    auto combined = juce::ValueTree::readFromData(data, static_cast<size_t>(sizeInBytes));
-    if (combined.isValid()) {
+    if (OmnifySettings::isBinary(data, static_cast<size_t>(sizeInBytes))) {
+        try {
+            juce::MemoryInputStream stream(data, static_cast<size_t>(sizeInBytes), false);
+            applySettings(std::make_shared<OmnifySettings>(OmnifySettings::from_binary(stream, chordVoicingRegistry, strumVoicingRegistry)));
+        } catch (const std::exception& e) {
+            DBG("Failed to load binary settings: " << e.what());
+            return;
+        }
+    } else {
+        // Sessions saved before the binary format: a ValueTree of APVTS state plus settings JSON
+        auto combined = juce::ValueTree::readFromData(data, static_cast<size_t>(sizeInBytes));
+        if (!combined.isValid()) {
+            return;
+        }
         auto apvtsState = combined.getChildWithName(parameters.state.getType());
         if (apvtsState.isValid()) {
             parameters.replaceState(apvtsState);
         }
 
-        auto savedStateTree = combined.getChildWithName(stateTree.getType());
+        auto savedStateTree = combined.getChildWithName(LEGACY_STATE_TREE_TYPE);
         if (savedStateTree.isValid()) {
-            stateTree = savedStateTree.createCopy();
+            loadSettingsFromValueTree(savedStateTree);
         }
+    }
 
-        loadSettingsFromValueTree();
-
-        // Tell editor to refresh if it exists
-        if (auto* editor = dynamic_cast<OmnifyAudioProcessorEditor*>(getActiveEditor())) {
-            editor->refreshFromSettings();
-        }
+    // Tell editor to refresh if it exists
+    if (auto* editor = dynamic_cast<OmnifyAudioProcessorEditor*>(getActiveEditor())) {
+        editor->refreshFromSettings();
     }
 }
 
@@ -131,7 +181,14 @@ void OmnifyAudioProcessor::modifySettings(std::function<void(OmnifySettings&)> m
     mutator(*newSettings);
     omnify->updateSettings(newSettings);
     std::atomic_store(&omnifySettings, newSettings);
-    saveSettingsToValueTree();
+    settingsEdits.fetch_add(1, std::memory_order_relaxed);
+}
+
+OmnifyAudioProcessor::SettingsPersistenceStats OmnifyAudioProcessor::getSettingsPersistenceStats() const {
+    return SettingsPersistenceStats{
+        .edits = settingsEdits.load(std::memory_order_relaxed),
+        .serializations = settingsSerializations.load(std::memory_order_relaxed),
+    };
 }
 
 void OmnifyAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue) {
@@ -143,15 +200,21 @@ void OmnifyAudioProcessor::parameterChanged(const juce::String& parameterID, flo
 }
 
 void OmnifyAudioProcessor::timerCallback() {
-    if (daemomnify) {
+    omnify->refreshStaleVoicings();
+    omnify->reclaimRetiredSettings();
+
+    // The host path gets its MIDI from the host, so there are no devices to manage
+    if (daemomnify && ENGINE_MODE == EngineMode::VirtualPort) {
         daemomnify->checkDevices();
     }
 }
 
 void OmnifyAudioProcessor::applySettingsFromJson(const juce::String& jsonString) {
     auto j = nlohmann::json::parse(jsonString.toStdString());
-    auto newSettings = std::make_shared<OmnifySettings>(OmnifySettings::from_json(j, chordVoicingRegistry, strumVoicingRegistry));
+    applySettings(std::make_shared<OmnifySettings>(OmnifySettings::from_json(j, chordVoicingRegistry, strumVoicingRegistry)));
+}
 
+void OmnifyAudioProcessor::applySettings(std::shared_ptr<OmnifySettings> newSettings) {
     omnify->updateSettings(newSettings, true);
     std::atomic_store(&omnifySettings, newSettings);
 
@@ -162,11 +225,15 @@ void OmnifyAudioProcessor::applySettingsFromJson(const juce::String& jsonString)
         strumCooldownParam->setValueNotifyingHost(strumCooldownParam->convertTo0to1(static_cast<float>(newSettings->strumCooldownMs)));
     }
 
-    setMidiInputDevice(juce::String(newSettings->midiDeviceName));
+    // Scanning devices is slow, and restoring a session does this for every instance, so skip it if nothing changed
+    juce::String deviceName(newSettings->midiDeviceName);
+    if (deviceName.isEmpty() || deviceName != connectedMidiDeviceName) {
+        setMidiInputDevice(deviceName);
+    }
 }
 
-void OmnifyAudioProcessor::loadSettingsFromValueTree() {
-    auto jsonString = stateTree.getProperty(SETTINGS_JSON_KEY, "").toString();
+void OmnifyAudioProcessor::loadSettingsFromValueTree(const juce::ValueTree& savedStateTree) {
+    auto jsonString = savedStateTree.getProperty(LEGACY_SETTINGS_JSON_KEY, "").toString();
     if (jsonString.isEmpty()) {
         return;
     }
@@ -178,17 +245,10 @@ void OmnifyAudioProcessor::loadSettingsFromValueTree() {
     }
 }
 
-void OmnifyAudioProcessor::saveSettingsToValueTree() {
-    auto settings = std::atomic_load(&omnifySettings);
-    auto jsonString = settings->to_json().dump();
-    stateTree.setProperty(SETTINGS_JSON_KEY, juce::String(jsonString), nullptr);
-}
-
 void OmnifyAudioProcessor::loadDefaultSettings() {
     try {
         juce::String jsonStr(BinaryData::default_settings_json, BinaryData::default_settings_jsonSize);
         applySettingsFromJson(jsonStr);
-        saveSettingsToValueTree();
         DBG("Loaded default settings from bundled JSON");
     } catch (const std::exception& e) {
         DBG("Failed to load default settings: " << e.what());
@@ -197,6 +257,7 @@ void OmnifyAudioProcessor::loadDefaultSettings() {
 
 //==============================================================================
 void OmnifyAudioProcessor::setMidiInputDevice(const juce::String& deviceName) {
+    connectedMidiDeviceName.clear();
     if (deviceName.isEmpty()) {
         daemomnify->setInputDevice(std::nullopt);
         closeMidiLearnInput();
@@ -207,37 +268,26 @@ void OmnifyAudioProcessor::setMidiInputDevice(const juce::String& deviceName) {
     for (const auto& device : devices) {
         if (device.name == deviceName) {
             daemomnify->setInputDevice(device.identifier);
-            openMidiLearnInput(deviceName);
+            openMidiLearnInput(device);
+            connectedMidiDeviceName = deviceName;
             return;
         }
     }
 
     daemomnify->setInputDevice(std::nullopt);
     closeMidiLearnInput();
+    logger->log("MIDI device not found for MIDI Learn: " + deviceName);
 }
 
-void OmnifyAudioProcessor::openMidiLearnInput(const juce::String& deviceName) {
+void OmnifyAudioProcessor::openMidiLearnInput(const juce::MidiDeviceInfo& device) {
     // Close existing input first
     closeMidiLearnInput();
 
-    if (deviceName.isEmpty()) {
-        return;
-    }
-
-    // Find the device by name
-    auto devices = juce::MidiInput::getAvailableDevices();
-    for (const auto& device : devices) {
-        if (device.name == deviceName) {
-            midiLearnInput = juce::MidiInput::openDevice(device.identifier, this);
-            if (midiLearnInput) {
-                midiLearnInput->start();
-                logger->log("Opened MIDI input for MIDI Learn: " + deviceName);
-            }
-            return;
-        }
+    midiLearnInput = juce::MidiInput::openDevice(device.identifier, this);
+    if (midiLearnInput) {
+        midiLearnInput->start();
+        logger->log("Opened MIDI input for MIDI Learn: " + device.name);
     }
-
-    logger->log("MIDI device not found for MIDI Learn: " + deviceName);
 }
 
 void OmnifyAudioProcessor::closeMidiLearnInput() {
@@ -3,10 +3,14 @@
 #include <juce_audio_devices/juce_audio_devices.h>
 #include <juce_audio_processors/juce_audio_processors.h>
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
 
+#include "Clock.h"
 #include "Daemomnify.h"
+#include "HostMidiSink.h"
 #include "MidiMessageScheduler.h"
 #include "Omnify.h"
 #include "OmnifyLogger.h"
@@ -21,6 +25,10 @@ class OmnifyAudioProcessor : public juce::AudioProcessor,
                              private juce::MidiInputCallback,
                              private juce::Timer {
    public:
+    // VirtualPort runs the engine on its own thread, reading a MIDI device directly and writing to a virtual "Omnify" port.
+    // InHost runs it inside processBlock on the host's MIDI, rewriting the buffer with sample-accurate output.
+    enum class EngineMode { VirtualPort, InHost };
+
     OmnifyAudioProcessor();
     ~OmnifyAudioProcessor() override;
 
@@ -37,8 +45,8 @@ class OmnifyAudioProcessor : public juce::AudioProcessor,
     //==============================================================================
     const juce::String getName() const override { return JucePlugin_Name; }
     bool acceptsMidi() const override { return true; }
-    bool producesMidi() const override { return false; }
-    bool isMidiEffect() const override { return false; }
+    bool producesMidi() const override { return JucePlugin_ProducesMidiOutput; }
+    bool isMidiEffect() const override { return JucePlugin_IsMidiEffect; }
     double getTailLengthSeconds() const override { return 0.0; }
 
     //==============================================================================
@@ -56,15 +64,23 @@ class OmnifyAudioProcessor : public juce::AudioProcessor,
     void modifySettings(std::function<void(OmnifySettings&)> mutator);
     void setMidiInputDevice(const juce::String& deviceName);
 
+    // Settings edits reach the engine immediately and are only serialized when the host asks for state.
+    // Every edit used to serialize all the settings on top of that, so each edit is a serialization avoided.
+    struct SettingsPersistenceStats {
+        uint64_t edits = 0;
+        uint64_t serializations = 0;
+    };
+    SettingsPersistenceStats getSettingsPersistenceStats() const;
+
     juce::AudioProcessorValueTreeState& getAPVTS() { return parameters; }
-    juce::ValueTree& getStateTree() { return stateTree; }  // TODO: remove once UI uses callbacks
 
     const VoicingStyleRegistry<VoicingFor::Chord>& getChordVoicingRegistry() const { return chordVoicingRegistry; }
     const VoicingStyleRegistry<VoicingFor::Strum>& getStrumVoicingRegistry() const { return strumVoicingRegistry; }
 
    private:
-    juce::ValueTree stateTree{"OmnifyState"};
-    static constexpr const char* SETTINGS_JSON_KEY = "settings_v1";
+    // Sessions saved before the binary state format keep their settings as JSON in a child ValueTree
+    static constexpr const char* LEGACY_STATE_TREE_TYPE = "OmnifyState";
+    static constexpr const char* LEGACY_SETTINGS_JSON_KEY = "settings_v1";
 
     juce::AudioProcessorValueTreeState parameters;
     juce::AudioParameterFloat* strumGateTimeParam = nullptr;
@@ -72,24 +88,39 @@ class OmnifyAudioProcessor : public juce::AudioProcessor,
 
     VoicingStyleRegistry<VoicingFor::Chord> chordVoicingRegistry;
     VoicingStyleRegistry<VoicingFor::Strum> strumVoicingRegistry;
-    void initVoicingRegistries();
 
     void parameterChanged(const juce::String& parameterID, float newValue) override;
     void timerCallback() override;
     void applySettingsFromJson(const juce::String& jsonString);
-    void loadSettingsFromValueTree();
-    void saveSettingsToValueTree();
+    void applySettings(std::shared_ptr<OmnifySettings> newSettings);
+    void loadSettingsFromValueTree(const juce::ValueTree& savedStateTree);
     void loadDefaultSettings();
 
+    std::atomic<uint64_t> settingsEdits{0};
+    std::atomic<uint64_t> settingsSerializations{0};
+
     std::unique_ptr<MidiMessageScheduler> midiScheduler;
     std::shared_ptr<RealtimeParams> realtimeParams;
     std::shared_ptr<OmnifySettings> omnifySettings;
     std::unique_ptr<Omnify> omnify;
     std::unique_ptr<Daemomnify> daemomnify;
 
+    // MIDI effect builds have no virtual port to write to, so they use the host path
+    static constexpr EngineMode ENGINE_MODE = JucePlugin_IsMidiEffect ? EngineMode::InHost : EngineMode::VirtualPort;
+
+    // In-host engine state, audio thread only
+    double hostSampleRate = 44100.0;
+    int64_t hostSamplePosition = 0;  // samples processed since hostClockStart
+    TimeNs hostClockStart = 0;       // engine time of sample 0, so sample positions and scheduled times share a clock
+    juce::MidiBuffer hostMidiOut;
+    HostMidiSink hostMidiSink;
+    void resetHostClock();
+    TimeNs hostSampleTime(int64_t samplePosition) const;
+
     // Direct MIDI input for MIDI Learn (bypasses DAW routing)
     std::unique_ptr<juce::MidiInput> midiLearnInput;
-    void openMidiLearnInput(const juce::String& deviceName);
+    juce::String connectedMidiDeviceName;  // name of the input device last found and opened, empty if none
+    void openMidiLearnInput(const juce::MidiDeviceInfo& device);
     void closeMidiLearnInput();
     void handleIncomingMidiMessage(juce::MidiInput* source, const juce::MidiMessage& message) override;
 
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/*
+ * Publishes immutable snapshots from the message thread to a single realtime reader, RCU style.
+ *
+ * The reader gets the current snapshot with one atomic load and no refcounting, inside a ReadScope.
+ * Replaced snapshots are kept on the publishing thread until the reader has been seen outside
+ * a ReadScope since the replacement, then freed there, so the reader never frees anything.
+ *
+ * publish() and reclaim() must be called from one thread (the message thread).
+ * ReadScopes may be opened by one thread at a time (the engine thread, or the audio thread for in-host use).
+ */
+template <typename T>
+class SnapshotPublisher {
+   public:
+    SnapshotPublisher() = default;
+
+    SnapshotPublisher(const SnapshotPublisher&) = delete;
+    SnapshotPublisher& operator=(const SnapshotPublisher&) = delete;
+
+    // Reader side. Holds the snapshot that was current when the scope was opened.
+    class ReadScope {
+       public:
+        explicit ReadScope(SnapshotPublisher& publisher) : publisher(publisher) {
+            // Odd means a read is in progress. Announce it before loading, so the publisher can't miss it.
+            sequence = publisher.readerSequence.load(std::memory_order_relaxed) + 1;
+            publisher.readerSequence.store(sequence, std::memory_order_seq_cst);
+            snapshot = publisher.published.load(std::memory_order_seq_cst);
+        }
+
+        ~ReadScope() { publisher.readerSequence.store(sequence + 1, std::memory_order_release); }
+
+        ReadScope(const ReadScope&) = delete;
+        ReadScope& operator=(const ReadScope&) = delete;
+
+        const T& operator*() const { return *snapshot; }
+        const T* operator->() const { return snapshot; }
+
+       private:
+        SnapshotPublisher& publisher;
+        const T* snapshot = nullptr;
+        uint64_t sequence = 0;
+    };
+
+    // Publisher side. Makes next current, retires the previous snapshot and frees any the reader is done with.
+    void publish(std::shared_ptr<const T> next) {
+        auto previous = std::exchange(owned, std::move(next));
+        published.store(owned.get(), std::memory_order_seq_cst);
+        if (previous) {
+            retired.push_back({std::move(previous), readerSequence.load(std::memory_order_seq_cst)});
+        }
+        reclaim();
+    }
+
+    // Publisher side. The current snapshot, for building the next one from.
+    const std::shared_ptr<const T>& current() const { return owned; }
+
+    // Publisher side. Frees retired snapshots the reader can no longer be using. Call periodically if
+    // publishes are rare, otherwise each publish() does it.
+    void reclaim() {
+        if (retired.empty()) {
+            return;
+        }
+        auto now = readerSequence.load(std::memory_order_acquire);
+        std::erase_if(retired, [now](const Retired& r) {
+            // Retired outside a read, or the read in progress at the time has since finished
+            return (r.readerSequence & 1) == 0 || now != r.readerSequence;
+        });
+    }
+
+    size_t getNumRetired() const { return retired.size(); }
+
+   private:
+    struct Retired {
+        std::shared_ptr<const T> snapshot;
+        uint64_t readerSequence;
+    };
+
+    std::atomic<const T*> published{nullptr};
+    std::atomic<uint64_t> readerSequence{0};
+
+    // Publisher thread only
+    std::shared_ptr<const T> owned;
+    std::vector<Retired> retired;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+/*
+ * Bounded single-producer / single-consumer queue.
+ *
+ * Storage is preallocated, and push / pop never lock or allocate, so it is safe to use
+ * from a MIDI callback on one side and a realtime engine thread on the other.
+ * Exactly one thread may push and exactly one thread may pop at any given time.
+ */
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>, "SpscQueue elements are copied without locks, so must be trivially copyable");
+
+   public:
+    SpscQueue() = default;
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer side. Returns false (and drops the item) if the queue is full.
+    bool push(const T& item) {
+        auto tail = writeIndex.load(std::memory_order_relaxed);
+        if (tail - cachedReadIndex == Capacity) {
+            cachedReadIndex = readIndex.load(std::memory_order_acquire);
+            if (tail - cachedReadIndex == Capacity) {
+                return false;
+            }
+        }
+        slots[tail & MASK] = item;
+        writeIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false if the queue is empty.
+    bool pop(T& item) {
+        auto head = readIndex.load(std::memory_order_relaxed);
+        if (head == cachedWriteIndex) {
+            cachedWriteIndex = writeIndex.load(std::memory_order_acquire);
+            if (head == cachedWriteIndex) {
+                return false;
+            }
+        }
+        item = slots[head & MASK];
+        readIndex.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called from neither the producer nor the consumer
+    bool isEmpty() const { return readIndex.load(std::memory_order_acquire) == writeIndex.load(std::memory_order_acquire); }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+   private:
+    static constexpr size_t MASK = Capacity - 1;
+    static constexpr size_t CACHE_LINE = 64;
+
+    // Producer and consumer indices live on separate cache lines so the two threads don't false-share
+    alignas(CACHE_LINE) std::atomic<size_t> writeIndex{0};
+    size_t cachedReadIndex = 0;  // producer's last view of readIndex
+
+    alignas(CACHE_LINE) std::atomic<size_t> readIndex{0};
+    size_t cachedWriteIndex = 0;  // consumer's last view of writeIndex
+
+    alignas(CACHE_LINE) std::array<T, Capacity> slots{};
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <algorithm>
+
+#include "Clock.h"
+#include "MidiEvent.h"
+
+// A short (<= 3 byte) MIDI message plus the time it arrived.
+// Trivially copyable so it can be passed through lock-free queues.
+struct TimestampedMidiEvent {
+    TimeNs timeNs = 0;
+    MidiEvent midi;        // bytes past size are zero
+    juce::uint8 size = 0;  // bytes of midi in use, 1 to 3
+
+    // Returns false for messages that don't fit, eg sysex
+    static bool fromMidiMessage(const juce::MidiMessage& msg, TimeNs timeNs, TimestampedMidiEvent& out) {
+        auto numBytes = msg.getRawDataSize();
+        if (numBytes <= 0 || numBytes > static_cast<int>(out.midi.bytes.size())) {
+            return false;
+        }
+        out.timeNs = timeNs;
+        out.midi = {};
+        out.size = static_cast<juce::uint8>(numBytes);
+        std::copy_n(msg.getRawData(), numBytes, out.midi.bytes.begin());
+        return true;
+    }
+
+    juce::MidiMessage toMidiMessage() const { return juce::MidiMessage(midi.bytes.data(), size); }
+};
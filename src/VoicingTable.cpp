@@ -0,0 +1,9 @@
+#include "VoicingTable.h"
+
+void compileChordVoicings(ChordVoicingTable& table, const VoicingStyle<VoicingFor::Chord>& style, VoicingModifier modifier) {
+    table.compile([&](ChordQuality quality, int root) { return applyVoicingModifier(style, modifier, quality, root); }, true);
+}
+
+void compileStrumVoicings(StrumVoicingTable& table, const VoicingStyle<VoicingFor::Strum>& style) {
+    table.compile([&](ChordQuality quality, int root) { return style.constructChord(quality, root); }, false);
+}
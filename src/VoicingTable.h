@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <exception>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "datamodel/ChordQuality.h"
+#include "datamodel/VoicingModifier.h"
+#include "datamodel/VoicingStyle.h"
+
+// One precomputed voicing, with notes already clamped to the MIDI range
+template <size_t MaxNotes>
+struct CompiledVoicing {
+    uint8_t count = 0;
+    std::array<uint8_t, MaxNotes> notes{};
+
+    std::span<const uint8_t> view() const noexcept { return {notes.data(), count}; }
+};
+
+/*
+ * Flat table of voicings for every (quality, root) pair.
+ *
+ * Built once from a VoicingStyle when settings change, so the engine only ever does an
+ * O(1) lookup that can't throw or allocate.
+ */
+template <size_t MaxNotes>
+class VoicingTable {
+   public:
+    static constexpr size_t NUM_ROOTS = 128;
+
+    const CompiledVoicing<MaxNotes>& lookup(ChordQuality quality, int root) const noexcept { return entries[indexOf(quality, root)]; }
+
+    // Entries whose voicing couldn't be built (eg missing from a chord file) compile to an empty voicing
+    int getNumFailedEntries() const { return numFailedEntries; }
+    const std::string& getFirstError() const { return firstError; }
+
+    // Applies build(quality, root) to every entry, clamping notes to 0..127.
+    // Duplicate notes after clamping are dropped if dedupe is set, notes past MaxNotes are always dropped.
+    template <typename Build>
+    void compile(Build&& build, bool dedupe) {
+        numFailedEntries = 0;
+        firstError.clear();
+        for (auto quality : ALL_CHORD_QUALITIES) {
+            for (int root = 0; root < static_cast<int>(NUM_ROOTS); ++root) {
+                auto& entry = entries[indexOf(quality, root)];
+                entry = {};
+                try {
+                    fill(entry, build(quality, root), dedupe);
+                } catch (const std::exception& e) {
+                    if (numFailedEntries++ == 0) {
+                        firstError = e.what();
+                    }
+                }
+            }
+        }
+    }
+
+   private:
+    std::array<CompiledVoicing<MaxNotes>, ALL_CHORD_QUALITIES.size() * NUM_ROOTS> entries{};
+    int numFailedEntries = 0;
+    std::string firstError;
+
+    static size_t indexOf(ChordQuality quality, int root) noexcept {
+        return (static_cast<size_t>(quality) * NUM_ROOTS) + (static_cast<size_t>(root) & (NUM_ROOTS - 1));
+    }
+
+    static void fill(CompiledVoicing<MaxNotes>& entry, const std::vector<int>& notes, bool dedupe) {
+        std::array<bool, NUM_ROOTS> seen{};
+        for (int note : notes) {
+            if (entry.count == MaxNotes) {
+                break;
+            }
+            auto clamped = static_cast<uint8_t>(std::clamp(note, 0, 127));
+            if (dedupe) {
+                if (seen[clamped]) {
+                    continue;
+                }
+                seen[clamped] = true;
+            }
+            entry.notes[entry.count++] = clamped;
+        }
+    }
+};
+
+inline constexpr size_t MAX_CHORD_NOTES = 16;
+inline constexpr size_t NUM_STRUM_ZONES = 13;
+
+using ChordVoicingTable = VoicingTable<MAX_CHORD_NOTES>;
+using StrumVoicingTable = VoicingTable<NUM_STRUM_ZONES>;
+
+// Chord voicings are deduped after clamping, one note-on per note
+void compileChordVoicings(ChordVoicingTable& table, const VoicingStyle<VoicingFor::Chord>& style, VoicingModifier modifier);
+
+// Strum voicings keep one note per strum plate zone, in order
+void compileStrumVoicings(StrumVoicingTable& table, const VoicingStyle<VoicingFor::Strum>& style);
@@ -0,0 +1,504 @@
+// Micro-benchmarks for the engine hot path.
+//
+// Reports ns/op and allocations/op for each case as JSON, so runs can be diffed between builds:
+//   OmnifyBench [--iterations N] [--filter substring] [--out file.json]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <json.hpp>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "Clock.h"
+#include "CompiledSettings.h"
+#include "InputRouting.h"
+#include "MidiEvent.h"
+#include "MidiMessageScheduler.h"
+#include "MidiSink.h"
+#include "Omnify.h"
+#include "TimestampedMidiEvent.h"
+#include "datamodel/ChordQuality.h"
+#include "datamodel/OmnifySettings.h"
+#include "datamodel/VoicingModifier.h"
+#include "voicing_styles/BuiltinVoicingStyles.h"
+
+// Every allocation in the process goes through here, so allocations/op covers the engine and everything it calls
+namespace {
+std::atomic<uint64_t> allocationCount{0};
+}
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (auto* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+using BenchClock = std::chrono::steady_clock;
+
+constexpr int CHORD_CHANNEL = 1;
+constexpr int STOP_CC = 20;
+constexpr int LATCH_CC = 21;
+constexpr int FIRST_QUALITY_NOTE = 24;  // one button per quality, below the chord notes
+constexpr int FIRST_CHORD_ROOT = 48;
+
+struct Options {
+    uint64_t iterations = 100000;
+    std::string filter;
+    std::string outPath;
+};
+
+// Counts what the engine sends, so the work can't be optimised away
+class CountingSink : public MidiSink {
+   public:
+    uint64_t count = 0;
+    void send(MidiEvent, TimeNs) override { ++count; }
+};
+
+class Runner {
+   public:
+    explicit Runner(Options options) : options(std::move(options)) { calibrate(); }
+
+    bool wants(const std::string& name) const { return options.filter.empty() || name.find(options.filter) != std::string::npos; }
+
+    // Times op(i) over all iterations in one go. Use when every op is independent of setup.
+    void measure(const std::string& name, nlohmann::json params, const std::function<void(uint64_t)>& op) {
+        for (uint64_t i = 0; i < warmupIterations(); ++i) {
+            op(i);
+        }
+
+        auto allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+        auto start = BenchClock::now();
+        for (uint64_t i = 0; i < options.iterations; ++i) {
+            op(i);
+        }
+        auto elapsed = BenchClock::now() - start;
+        auto allocations = allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+
+        record(name, std::move(params), static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()), allocations);
+    }
+
+    // Runs setup(i) untimed before each timed op(i), for ops that need state put back first (eg a chord to stop).
+    // Each op is timed on its own, with the cost of reading the clock subtracted.
+    void measureWithSetup(const std::string& name, nlohmann::json params, const std::function<void(uint64_t)>& setup,
+                          const std::function<void(uint64_t)>& op) {
+        for (uint64_t i = 0; i < warmupIterations(); ++i) {
+            setup(i);
+            op(i);
+        }
+
+        double totalNs = 0;
+        uint64_t allocations = 0;
+        for (uint64_t i = 0; i < options.iterations; ++i) {
+            setup(i);
+            auto allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+            auto start = BenchClock::now();
+            op(i);
+            auto elapsed = BenchClock::now() - start;
+            allocations += allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+            totalNs += static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) - clockOverheadNs;
+        }
+
+        record(name, std::move(params), std::max(0.0, totalNs), allocations);
+    }
+
+    nlohmann::json toJson() const {
+        return nlohmann::json{
+            {"iterations", options.iterations},
+            {"clockOverheadNs", clockOverheadNs},
+            {"results", results},
+        };
+    }
+
+   private:
+    Options options;
+    double clockOverheadNs = 0;
+    nlohmann::json results = nlohmann::json::array();
+
+    uint64_t warmupIterations() const { return std::max<uint64_t>(1, options.iterations / 10); }
+
+    void calibrate() {
+        constexpr int samples = 100000;
+        auto start = BenchClock::now();
+        for (int i = 0; i < samples; ++i) {
+            [[maybe_unused]] auto t = BenchClock::now();
+        }
+        auto elapsed = BenchClock::now() - start;
+        clockOverheadNs = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / samples;
+    }
+
+    void record(const std::string& name, nlohmann::json params, double totalNs, uint64_t allocations) {
+        auto iterations = static_cast<double>(options.iterations);
+        params["name"] = name;
+        params["nsPerOp"] = totalNs / iterations;
+        params["allocationsPerOp"] = static_cast<double>(allocations) / iterations;
+        std::cerr << name << " " << params.dump() << "\n";
+        results.push_back(std::move(params));
+    }
+};
+
+Options parseOptions(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            options.iterations = std::max<uint64_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "--out" && i + 1 < argc) {
+            options.outPath = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--iterations N] [--filter substring] [--out file.json]\n";
+            std::exit(1);
+        }
+    }
+    return options;
+}
+
+std::shared_ptr<OmnifySettings> makeSettings(std::shared_ptr<VoicingStyle<VoicingFor::Chord>> chordStyle,
+                                             std::shared_ptr<VoicingStyle<VoicingFor::Strum>> strumStyle, VoicingModifier modifier) {
+    auto settings = std::make_shared<OmnifySettings>();
+    settings->chordChannel = CHORD_CHANNEL;
+    settings->chordVoicingStyle = std::move(chordStyle);
+    settings->strumVoicingStyle = std::move(strumStyle);
+    settings->voicingModifier = modifier;
+    settings->stopButton = MidiButton::fromCC(STOP_CC);
+    settings->latchButton = MidiButton::fromCC(LATCH_CC, true);
+
+    ButtonPerChordQuality buttons;
+    for (size_t i = 0; i < ALL_CHORD_QUALITIES.size(); ++i) {
+        buttons.notes[FIRST_QUALITY_NOTE + static_cast<int>(i)] = ALL_CHORD_QUALITIES[i];
+    }
+    settings->chordQualitySelectionStyle = ChordQualitySelectionStyle(buttons);
+    return settings;
+}
+
+// One engine instance driven through either handle() or process(), on virtual time
+class EngineFixture {
+   public:
+    EngineFixture(std::shared_ptr<OmnifySettings> settings, bool useHandle)
+        : omnify(scheduler, std::move(settings), std::make_shared<RealtimeParams>(), clock), useHandle(useHandle) {}
+
+    void send(const juce::MidiMessage& message) {
+        clock.advance(NS_PER_MS);
+        if (useHandle) {
+            sink.count += omnify.handle(message).size();
+            return;
+        }
+        TimestampedMidiEvent event;
+        TimestampedMidiEvent::fromMidiMessage(message, clock.now(), event);
+        omnify.process(std::span(&event, 1), sink);
+    }
+
+    // Keeps the scheduler from filling up with strum note-offs, outside the timed region
+    void flushScheduler() { scheduler.sendOverdueMessages(clock.now() + msToNs(60 * 1000), sink); }
+
+   private:
+    VirtualClock clock;
+    MidiMessageScheduler scheduler;
+    CountingSink sink;
+    Omnify omnify;
+    bool useHandle;
+};
+
+void benchOmnify(Runner& runner, const std::string& chordStyleName, std::shared_ptr<VoicingStyle<VoicingFor::Chord>> chordStyle,
+                 const std::string& strumStyleName, std::shared_ptr<VoicingStyle<VoicingFor::Strum>> strumStyle, VoicingModifier modifier) {
+    auto settings = makeSettings(std::move(chordStyle), std::move(strumStyle), modifier);
+
+    auto compiled = CompiledSettings::compile(settings);
+    auto totalEntries = static_cast<int>(ALL_CHORD_QUALITIES.size() * ChordVoicingTable::NUM_ROOTS);
+    if (compiled->chordVoicings.getNumFailedEntries() == totalEntries || compiled->strumVoicings.getNumFailedEntries() == totalEntries) {
+        std::cerr << "skipping " << chordStyleName << " / " << strumStyleName << ": " << compiled->chordVoicings.getFirstError()
+                  << compiled->strumVoicings.getFirstError() << "\n";
+        return;
+    }
+
+    auto chordOn = [](uint64_t i) { return juce::MidiMessage::noteOn(CHORD_CHANNEL, FIRST_CHORD_ROOT + static_cast<int>(i % 12), juce::uint8{100}); };
+    auto chordOff = [](uint64_t i) { return juce::MidiMessage::noteOff(CHORD_CHANNEL, FIRST_CHORD_ROOT + static_cast<int>(i % 12)); };
+
+    for (bool useHandle : {true, false}) {
+        nlohmann::json params = {
+            {"entry", useHandle ? "handle" : "process"},
+            {"chordStyle", chordStyleName},
+            {"strumStyle", strumStyleName},
+            {"modifier", modifier},
+        };
+        auto prefix = std::string("omnify/") + (useHandle ? "handle" : "process") + "/";
+
+        if (runner.wants(prefix + "chord_note_on")) {
+            EngineFixture f(settings, useHandle);
+            runner.measure(prefix + "chord_note_on", params, [&](uint64_t i) { f.send(chordOn(i)); });
+        }
+
+        if (runner.wants(prefix + "chord_note_off")) {
+            EngineFixture f(settings, useHandle);
+            runner.measureWithSetup(
+                prefix + "chord_note_off", params, [&](uint64_t i) { f.send(chordOn(i)); }, [&](uint64_t i) { f.send(chordOff(i)); });
+        }
+
+        if (runner.wants(prefix + "strum")) {
+            EngineFixture f(settings, useHandle);
+            f.send(chordOn(0));
+            // Step across the plate so every strum lands in a new zone and plays
+            runner.measure(prefix + "strum", params, [&](uint64_t i) {
+                f.send(juce::MidiMessage::controllerEvent(settings->strumChannel, settings->strumPlateCC, static_cast<int>((i * 11) % 128)));
+                if ((i & 1023) == 1023) {
+                    f.flushScheduler();
+                }
+            });
+        }
+
+        if (runner.wants(prefix + "quality_change")) {
+            EngineFixture f(settings, useHandle);
+            runner.measure(prefix + "quality_change", params, [&](uint64_t i) {
+                auto note = FIRST_QUALITY_NOTE + static_cast<int>(i % ALL_CHORD_QUALITIES.size());
+                f.send(juce::MidiMessage::noteOn(CHORD_CHANNEL, note, juce::uint8{100}));
+            });
+        }
+
+        if (runner.wants(prefix + "latch")) {
+            EngineFixture f(settings, useHandle);
+            // Alternates latch on and off, releasing a sounding chord each time it goes off
+            runner.measureWithSetup(
+                prefix + "latch", params, [&](uint64_t i) { f.send(chordOn(i)); },
+                [&](uint64_t i) { f.send(juce::MidiMessage::controllerEvent(CHORD_CHANNEL, LATCH_CC, (i & 1) == 0 ? 127 : 0)); });
+        }
+
+        if (runner.wants(prefix + "stop")) {
+            EngineFixture f(settings, useHandle);
+            runner.measureWithSetup(
+                prefix + "stop", params, [&](uint64_t i) { f.send(chordOn(i)); },
+                [&](uint64_t) { f.send(juce::MidiMessage::controllerEvent(CHORD_CHANNEL, STOP_CC, 127)); });
+        }
+    }
+}
+
+// The sequential handler chain the engine used before routing tables, kept as the baseline for benchDispatch.
+// Returns the action the first handler to claim msg would have taken.
+InputAction dispatchByHandlerChain(const juce::MidiMessage& msg, const OmnifySettings& s) {
+    bool qualitySelected = false;
+    std::visit(
+        [&](auto&& style) {
+            using T = std::decay_t<decltype(style)>;
+            if constexpr (std::is_same_v<T, ButtonPerChordQuality>) {
+                if (msg.isNoteOn() && msg.getVelocity() > 0) {
+                    qualitySelected = style.notes.find(msg.getNoteNumber()) != style.notes.end();
+                } else if (msg.isController()) {
+                    auto it = style.ccs.find(msg.getControllerNumber());
+                    qualitySelected = it != style.ccs.end() && msg.getControllerValue() > 63;
+                }
+            } else if constexpr (std::is_same_v<T, CCRangePerChordQuality>) {
+                qualitySelected = msg.isController() && msg.getControllerNumber() == style.cc;
+            }
+        },
+        s.chordQualitySelectionStyle.value);
+
+    if (qualitySelected) {
+        return InputAction::CHORD_QUALITY;
+    }
+    if (s.stopButton.handle(msg)) {
+        return InputAction::STOP;
+    }
+    if (s.latchButton.handle(msg)) {
+        return InputAction::LATCH;
+    }
+    if (msg.isNoteOn() && msg.getVelocity() > 0) {
+        return InputAction::CHORD_NOTE_ON;
+    }
+    if (msg.isNoteOff()) {
+        return InputAction::CHORD_NOTE_OFF;
+    }
+    if (msg.isController() && msg.getControllerNumber() == s.strumPlateCC) {
+        return InputAction::STRUM;
+    }
+    return InputAction::NONE;
+}
+
+volatile uint64_t dispatchedActions = 0;
+
+// Dispatch alone, per input message: the old handler chain (including the MidiMessage it was run on) against a routing table lookup
+void benchDispatch(Runner& runner, std::shared_ptr<VoicingStyle<VoicingFor::Chord>> chordStyle,
+                   std::shared_ptr<VoicingStyle<VoicingFor::Strum>> strumStyle) {
+    auto compiled = CompiledSettings::compile(makeSettings(std::move(chordStyle), std::move(strumStyle), VoicingModifier::NONE));
+    const auto& settings = *compiled->settings;
+
+    std::vector<std::pair<std::string, juce::MidiMessage>> messages = {
+        {"strum_cc", juce::MidiMessage::controllerEvent(CHORD_CHANNEL, settings.strumPlateCC, 64)},
+        {"chord_note_on", juce::MidiMessage::noteOn(CHORD_CHANNEL, FIRST_CHORD_ROOT, juce::uint8{100})},
+        {"chord_note_off", juce::MidiMessage::noteOff(CHORD_CHANNEL, FIRST_CHORD_ROOT)},
+        {"quality_note", juce::MidiMessage::noteOn(CHORD_CHANNEL, FIRST_QUALITY_NOTE, juce::uint8{100})},
+        {"stop_cc", juce::MidiMessage::controllerEvent(CHORD_CHANNEL, STOP_CC, 127)},
+    };
+
+    for (const auto& [messageName, message] : messages) {
+        TimestampedMidiEvent event;
+        TimestampedMidiEvent::fromMidiMessage(message, 0, event);
+        const auto& bytes = event.midi.bytes;
+        if (dispatchByHandlerChain(message, settings) != compiled->inputRoutes.lookup(bytes[0], bytes[1], bytes[2]).actionFor(bytes[2])) {
+            std::cerr << "dispatch mismatch for " << messageName << "\n";
+            std::abort();
+        }
+
+        uint64_t actions = 0;
+        if (runner.wants("dispatch/handler_chain")) {
+            runner.measure("dispatch/handler_chain", {{"message", messageName}}, [&](uint64_t) {
+                actions += static_cast<uint64_t>(dispatchByHandlerChain(event.toMidiMessage(), settings));
+            });
+        }
+        if (runner.wants("dispatch/routing_table")) {
+            runner.measure("dispatch/routing_table", {{"message", messageName}}, [&](uint64_t) {
+                const auto& route = compiled->inputRoutes.lookup(bytes[0], bytes[1], bytes[2]);
+                actions += static_cast<uint64_t>(route.actionFor(bytes[2]));
+            });
+        }
+        dispatchedActions = actions;  // keeps the work from being optimised away
+    }
+}
+
+void benchSmoothVoicing(Runner& runner) {
+    if (!runner.wants("smooth_voicing")) {
+        return;
+    }
+    runner.measure("smooth_voicing", nlohmann::json::object(), [](uint64_t i) {
+        auto quality = ALL_CHORD_QUALITIES[i % ALL_CHORD_QUALITIES.size()];
+        auto notes = smoothVoicing(getChordQualityData(quality).offsets, static_cast<int>(i % 128));
+        if (notes.empty()) {
+            std::abort();
+        }
+    });
+}
+
+void benchScheduler(Runner& runner, size_t pending) {
+    auto name = "scheduler/push_pop";
+    if (!runner.wants(name)) {
+        return;
+    }
+
+    // Steady state: each op schedules one message and sends the one that has just come due, with `pending` in flight.
+    // Sends are spread 10us apart, so even the largest case stays within one lap of the wheel.
+    constexpr TimeNs step = 10'000;
+    auto delay = static_cast<TimeNs>(pending) * step;
+
+    MidiMessageScheduler scheduler(pending + 16);
+    CountingSink sink;
+    TimeNs now = 0;
+    auto message = MidiEvent::noteOff(1, 60);
+    for (size_t i = 0; i < pending; ++i) {
+        scheduler.schedule(message, now, static_cast<TimeNs>(i + 1) * step);
+    }
+
+    runner.measure(name, {{"pending", pending}}, [&](uint64_t) {
+        now += step;
+        scheduler.schedule(message, now, delay);
+        scheduler.sendOverdueMessages(now, sink);
+    });
+
+    if (scheduler.getNumDropped() > 0) {
+        std::cerr << "scheduler dropped " << scheduler.getNumDropped() << " messages, results are not steady state\n";
+    }
+}
+
+// Compiling settings into voicing and routing tables, which happens on every settings edit
+void benchSettingsCompile(Runner& runner, const std::string& chordStyleName, std::shared_ptr<VoicingStyle<VoicingFor::Chord>> chordStyle,
+                          std::shared_ptr<VoicingStyle<VoicingFor::Strum>> strumStyle) {
+    if (!runner.wants("settings/compile")) {
+        return;
+    }
+    for (auto modifier : {VoicingModifier::NONE, VoicingModifier::FIXED, VoicingModifier::SMOOTH}) {
+        auto settings = makeSettings(chordStyle, strumStyle, modifier);
+        runner.measure("settings/compile", {{"chordStyle", chordStyleName}, {"modifier", modifier}}, [&](uint64_t) {
+            if (!CompiledSettings::compile(settings)) {
+                std::abort();
+            }
+        });
+    }
+}
+
+// Per-instance plugin state restore, for the binary state format and the JSON one it replaced
+void benchSettingsRestore(Runner& runner, VoicingStyleRegistry<VoicingFor::Chord>& chordRegistry,
+                          VoicingStyleRegistry<VoicingFor::Strum>& strumRegistry) {
+    auto settings = makeSettings(chordRegistry.getRegistry().at("Omnichord").style, strumRegistry.getRegistry().at("Omnichord").style,
+                                 VoicingModifier::NONE);
+
+    if (runner.wants("settings/restore_json")) {
+        auto json = settings->to_json().dump();
+        runner.measure("settings/restore_json", {{"bytes", json.size()}}, [&](uint64_t) {
+            auto restored = OmnifySettings::from_json(nlohmann::json::parse(json), chordRegistry, strumRegistry);
+            if (restored.chordChannel != settings->chordChannel) {
+                std::abort();
+            }
+        });
+    }
+
+    if (runner.wants("settings/restore_binary")) {
+        juce::MemoryBlock binary;
+        {
+            juce::MemoryOutputStream out(binary, false);
+            settings->to_binary(out);
+        }
+        runner.measure("settings/restore_binary", {{"bytes", binary.getSize()}}, [&](uint64_t) {
+            juce::MemoryInputStream in(binary, false);
+            auto restored = OmnifySettings::from_binary(in, chordRegistry, strumRegistry);
+            if (restored.chordChannel != settings->chordChannel) {
+                std::abort();
+            }
+        });
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    auto options = parseOptions(argc, argv);
+    auto outPath = options.outPath;
+    Runner runner(std::move(options));
+
+    VoicingStyleRegistry<VoicingFor::Chord> chordRegistry;
+    VoicingStyleRegistry<VoicingFor::Strum> strumRegistry;
+    registerBuiltinVoicingStyles(chordRegistry, strumRegistry);
+
+    for (const auto& [chordStyleName, chordEntry] : chordRegistry.getRegistry()) {
+        for (const auto& [strumStyleName, strumEntry] : strumRegistry.getRegistry()) {
+            for (auto modifier : {VoicingModifier::NONE, VoicingModifier::FIXED, VoicingModifier::SMOOTH}) {
+                benchOmnify(runner, chordStyleName, chordEntry.style, strumStyleName, strumEntry.style, modifier);
+            }
+        }
+    }
+
+    benchDispatch(runner, chordRegistry.getRegistry().at("Omnichord").style, strumRegistry.getRegistry().at("Omnichord").style);
+    benchSmoothVoicing(runner);
+    benchSettingsRestore(runner, chordRegistry, strumRegistry);
+    for (const auto& [chordStyleName, chordEntry] : chordRegistry.getRegistry()) {
+        benchSettingsCompile(runner, chordStyleName, chordEntry.style, strumRegistry.getRegistry().at("Omnichord").style);
+    }
+
+    for (size_t pending : {size_t{10}, size_t{1000}, size_t{100000}}) {
+        benchScheduler(runner, pending);
+    }
+
+    auto json = runner.toJson().dump(2);
+    if (outPath.empty()) {
+        std::cout << json << "\n";
+    } else {
+        std::ofstream(outPath) << json << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,49 @@
+// Converts a JSON chord file (eg Omnichord Facts/om_108_chord_voicings.json) to the binary chord table format,
+// which FromFile loads without parsing.
+//
+//   omnify-chordc input.json output.omct
+
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <json.hpp>
+#include <string>
+
+#include "voicing_styles/ChordTable.h"
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " input.json output.omct\n";
+        return 1;
+    }
+    std::string inPath = argv[1];
+    std::string outPath = argv[2];
+
+    try {
+        std::ifstream in(inPath);
+        if (!in) {
+            throw std::runtime_error("Can't open " + inPath);
+        }
+        auto table = ChordTable::fromJson(nlohmann::json::parse(in));
+
+        // Write beside the target and rename over it, so a FromFile watching it never reads a half-written file
+        auto tempPath = outPath + ".tmp";
+        {
+            std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+            table->writeBinary(out);
+            if (!out) {
+                throw std::runtime_error("Can't write " + tempPath);
+            }
+        }
+        std::filesystem::rename(tempPath, outPath);
+
+        std::cerr << "Wrote " << outPath << ": \"" << table->getName() << "\", " << (table->isPerRoot() ? "per root" : "per pitch class")
+                  << (table->isOffsetTable() ? ", offsets" : ", notes") << ", " << std::filesystem::file_size(outPath) << " bytes\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Conversion failed: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
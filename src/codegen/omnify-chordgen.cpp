@@ -0,0 +1,122 @@
+// Build-time generator: compiles JSON chord files into constexpr BuiltinChordTables, so the voicings in
+// Omnichord Facts ship inside the engine instead of being loaded through FromFile.
+//
+//   omnify-chordgen output.h IDENTIFIER input.json [IDENTIFIER input.json ...]
+//
+// Run by CMake whenever a chord file changes; the output is written to the build tree, not checked in.
+
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <json.hpp>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "voicing_styles/BuiltinChordTable.h"
+
+namespace {
+
+std::string cppStringLiteral(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        switch (c) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            default:
+                out += c;
+        }
+    }
+    return out + "\"";
+}
+
+// Same validation as FromFile's 12-key chord files, plus the limits of BuiltinChordTable
+void writeTable(std::ostream& out, const std::string& identifier, const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Can't open " + path);
+    }
+    auto j = nlohmann::json::parse(in);
+
+    std::map<ChordQuality, std::map<int, std::vector<int>>> chords;
+    for (const auto& [qualityName, rootMap] : j.at("chords").items()) {
+        for (const auto& [rootStr, notes] : rootMap.items()) {
+            chords[chordQualityFromName(qualityName)][std::stoi(rootStr)] = notes.get<std::vector<int>>();
+        }
+    }
+
+    out << "inline constexpr BuiltinChordTable " << identifier << " = {\n";
+    out << "    " << cppStringLiteral(j.at("name").get<std::string>()) << ",\n";
+    out << "    " << cppStringLiteral(j.at("description").get<std::string>()) << ",\n";
+    out << "    " << (j.at("isOffsetFile").get<bool>() ? "true" : "false") << ",\n";
+    out << "    {{\n";
+    for (auto quality : ALL_CHORD_QUALITIES) {
+        const auto& qualityName = getChordQualityData(quality).name;
+        const auto& voicings = chords[quality];
+        if (voicings.size() != BuiltinChordTable::NUM_PITCH_CLASSES) {
+            throw std::runtime_error(path + ": " + qualityName + " must have a voicing for each of the 12 pitch classes");
+        }
+        out << "        {{  // " << qualityName << "\n";
+        for (int pitchClass = 0; pitchClass < static_cast<int>(BuiltinChordTable::NUM_PITCH_CLASSES); ++pitchClass) {
+            auto it = voicings.find(pitchClass);
+            if (it == voicings.end() || it->second.empty() || it->second.size() > BuiltinChordTable::MAX_NOTES) {
+                throw std::runtime_error(path + ": " + qualityName + " on " + std::to_string(pitchClass) + " must have 1 to " +
+                                         std::to_string(BuiltinChordTable::MAX_NOTES) + " notes");
+            }
+            out << "            {" << it->second.size() << ", {";
+            for (size_t i = 0; i < it->second.size(); ++i) {
+                int note = it->second[i];
+                if (note < std::numeric_limits<int8_t>::min() || note > std::numeric_limits<int8_t>::max()) {
+                    throw std::runtime_error(path + ": note " + std::to_string(note) + " out of range");
+                }
+                out << (i == 0 ? "" : ", ") << note;
+            }
+            out << "}},\n";
+        }
+        out << "        }},\n";
+    }
+    out << "    }},\n";
+    out << "};\n\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 4 || argc % 2 != 0) {
+        std::cerr << "Usage: " << argv[0] << " output.h IDENTIFIER input.json [IDENTIFIER input.json ...]\n";
+        return 1;
+    }
+    std::string outPath = argv[1];
+
+    try {
+        std::ostringstream out;
+        out << "// Generated by omnify-chordgen. Do not edit.\n\n";
+        out << "#pragma once\n\n";
+        out << "#include \"voicing_styles/BuiltinChordTable.h\"\n\n";
+        out << "// clang-format off\n";
+        for (int i = 2; i < argc; i += 2) {
+            writeTable(out, argv[i], argv[i + 1]);
+        }
+        out << "// clang-format on\n";
+
+        std::ofstream file(outPath, std::ios::trunc);
+        file << out.str();
+        if (!file) {
+            throw std::runtime_error("Can't write " + outPath);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "omnify-chordgen: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
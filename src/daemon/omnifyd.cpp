@@ -0,0 +1,154 @@
+// Headless Omnify: runs Daemomnify from a settings file, with no GUI and no audio device.
+//
+//   omnifyd --settings settings.json [--output-port Omnify] [--wake-mode polling|event]
+//
+// The settings file uses the same schema as the plugin's saved settings (OmnifySettings::from_json).
+// --wake-mode picks how the engine thread waits for work (event by default). How often it woke is printed on exit,
+// next to the latency stats, for comparing the two.
+// Runs until SIGINT or SIGTERM.
+
+#include <juce_audio_devices/juce_audio_devices.h>
+#include <juce_events/juce_events.h>
+
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <json.hpp>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "Daemomnify.h"
+#include "MidiMessageScheduler.h"
+#include "Omnify.h"
+#include "datamodel/OmnifySettings.h"
+#include "voicing_styles/BuiltinVoicingStyles.h"
+
+namespace {
+
+constexpr int CHECK_DEVICES_INTERVAL_MS = 100;
+
+volatile std::sig_atomic_t shouldExit = 0;
+
+void handleSignal(int) { shouldExit = 1; }
+
+struct Options {
+    std::string settingsPath;
+    std::string outputPortName = "Omnify";
+    Daemomnify::WakeMode wakeMode = Daemomnify::WakeMode::EventDriven;
+};
+
+std::optional<Options> parseOptions(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--settings" && i + 1 < argc) {
+            options.settingsPath = argv[++i];
+        } else if (arg == "--output-port" && i + 1 < argc) {
+            options.outputPortName = argv[++i];
+        } else if (arg == "--wake-mode" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "polling") {
+                options.wakeMode = Daemomnify::WakeMode::Polling;
+            } else if (mode == "event") {
+                options.wakeMode = Daemomnify::WakeMode::EventDriven;
+            } else {
+                return std::nullopt;
+            }
+        } else {
+            return std::nullopt;
+        }
+    }
+    if (options.settingsPath.empty()) {
+        return std::nullopt;
+    }
+    return options;
+}
+
+// Input devices are saved by name, but opened by identifier, which can change between runs
+std::optional<juce::String> findInputDevice(const std::string& deviceName) {
+    if (deviceName.empty()) {
+        return std::nullopt;
+    }
+    for (const auto& device : juce::MidiInput::getAvailableDevices()) {
+        if (device.name == juce::String(deviceName)) {
+            return device.identifier;
+        }
+    }
+    return std::nullopt;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    auto options = parseOptions(argc, argv);
+    if (!options) {
+        std::cerr << "Usage: " << argv[0] << " --settings settings.json [--output-port name] [--wake-mode polling|event]\n";
+        return 1;
+    }
+
+    // Sets up the message manager, which JUCE's MIDI devices expect, without creating any windows
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    VoicingStyleRegistry<VoicingFor::Chord> chordRegistry;
+    VoicingStyleRegistry<VoicingFor::Strum> strumRegistry;
+    registerBuiltinVoicingStyles(chordRegistry, strumRegistry);
+
+    std::shared_ptr<OmnifySettings> settings;
+    try {
+        std::ifstream in(options->settingsPath);
+        if (!in) {
+            std::cerr << "Can't open settings file: " << options->settingsPath << "\n";
+            return 1;
+        }
+        auto j = nlohmann::json::parse(in);
+        settings = std::make_shared<OmnifySettings>(OmnifySettings::from_json(j, chordRegistry, strumRegistry));
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to load settings from " << options->settingsPath << ": " << e.what() << "\n";
+        return 1;
+    }
+
+    MidiMessageScheduler scheduler;
+    auto realtimeParams = std::make_shared<RealtimeParams>();
+    Omnify omnify(scheduler, settings, realtimeParams);
+
+    Daemomnify daemomnify(omnify, scheduler, juce::String(options->outputPortName));
+    daemomnify.setWakeMode(options->wakeMode);
+    daemomnify.start();
+
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+
+    std::cerr << "omnifyd: reading \"" << settings->midiDeviceName << "\", writing \"" << options->outputPortName << "\"\n";
+
+    std::optional<juce::String> inputDevice;
+    while (shouldExit == 0) {
+        // Keep looking for the device by name, so it can be plugged in after we start.
+        // Once found, Daemomnify keeps retrying it by identifier if it goes away.
+        if (!inputDevice) {
+            inputDevice = findInputDevice(settings->midiDeviceName);
+            if (inputDevice) {
+                daemomnify.setInputDevice(inputDevice);
+                std::cerr << "omnifyd: found input device\n";
+            }
+        }
+        daemomnify.checkDevices();
+        omnify.refreshStaleVoicings();
+        omnify.reclaimRetiredSettings();
+        juce::Thread::sleep(CHECK_DEVICES_INTERVAL_MS);
+    }
+
+    daemomnify.stop();
+
+    auto printLatency = [](const char* name, const LatencyHistogram::Snapshot& s) {
+        std::cerr << "omnifyd: " << name << " n=" << s.count << " p50=" << nsToMs(s.p50Ns) << "ms p99=" << nsToMs(s.p99Ns)
+                  << "ms max=" << nsToMs(s.maxNs) << "ms\n";
+    };
+    auto queueDelay = daemomnify.getQueueDelayStats();
+    std::cerr << "omnifyd: queue delay n=" << queueDelay.count << " mean=" << queueDelay.meanMs() << "ms max=" << queueDelay.maxMs
+              << "ms\n";
+    printLatency("input latency", daemomnify.getInputLatency());
+    printLatency("scheduler lateness", daemomnify.getSchedulerLateness());
+    std::cerr << "omnifyd: engine wakeups n=" << daemomnify.getWakeupCount() << "\n";
+    return 0;
+}
@@ -1,5 +1,90 @@
 #include "OmnifySettings.h"
 
+#include <stdexcept>
+#include <type_traits>
+#include <variant>
+
+namespace {
+
+// Binary selection style tags, never renumber
+constexpr juce::int8 BUTTON_PER_CHORD_QUALITY = 0;
+constexpr juce::int8 CC_RANGE_PER_CHORD_QUALITY = 1;
+
+void writeStyle(juce::OutputStream& out, const nlohmann::json& j) { out.writeString(juce::String(j.dump())); }
+
+void writeButton(juce::OutputStream& out, const MidiButton& button) {
+    out.writeInt(button.note);
+    out.writeInt(button.cc);
+    out.writeBool(button.ccIsToggle);
+}
+
+void writeQualityMap(juce::OutputStream& out, const std::map<int, ChordQuality>& map) {
+    out.writeInt(static_cast<int>(map.size()));
+    for (const auto& [number, quality] : map) {
+        out.writeInt(number);
+        out.writeByte(static_cast<char>(quality));
+    }
+}
+
+// Reads go through here so truncated data is reported rather than read as zeros
+void require(juce::InputStream& in, juce::int64 numBytes) {
+    if (in.getNumBytesRemaining() < numBytes) {
+        throw std::runtime_error("OmnifySettings binary data is truncated");
+    }
+}
+
+int readInt(juce::InputStream& in) {
+    require(in, 4);
+    return in.readInt();
+}
+
+bool readBool(juce::InputStream& in) {
+    require(in, 1);
+    return in.readBool();
+}
+
+juce::int8 readByte(juce::InputStream& in) {
+    require(in, 1);
+    return static_cast<juce::int8>(in.readByte());
+}
+
+std::string readString(juce::InputStream& in) {
+    require(in, 1);  // at least the terminator
+    return in.readString().toStdString();
+}
+
+template <VoicingFor T>
+std::shared_ptr<VoicingStyle<T>> readStyle(juce::InputStream& in, VoicingStyleRegistry<T>& registry) {
+    return registry.from_json(nlohmann::json::parse(readString(in)));
+}
+
+MidiButton readButton(juce::InputStream& in) {
+    MidiButton button;
+    button.note = readInt(in);
+    button.cc = readInt(in);
+    button.ccIsToggle = readBool(in);
+    return button;
+}
+
+std::map<int, ChordQuality> readQualityMap(juce::InputStream& in) {
+    auto count = readInt(in);
+    if (count < 0 || count > 256) {
+        throw std::runtime_error("OmnifySettings binary data has a bad chord quality button count");
+    }
+    std::map<int, ChordQuality> map;
+    for (int i = 0; i < count; ++i) {
+        auto number = readInt(in);
+        auto quality = readByte(in);
+        if (quality < 0 || static_cast<size_t>(quality) >= ALL_CHORD_QUALITIES.size()) {
+            throw std::runtime_error("OmnifySettings binary data has an unknown chord quality");
+        }
+        map[number] = static_cast<ChordQuality>(quality);
+    }
+    return map;
+}
+
+}  // namespace
+
 nlohmann::json OmnifySettings::to_json() const {
     nlohmann::json j;
     j["midiDeviceName"] = midiDeviceName;
@@ -47,4 +132,92 @@ OmnifySettings OmnifySettings::from_json(const nlohmann::json& j,
     settings.stopButton = j.at("stopButton").get<MidiButton>();
 
     return settings;
-}
\ No newline at end of file
+}
+
+void OmnifySettings::to_binary(juce::OutputStream& out) const {
+    out.writeInt(BINARY_MAGIC);
+    out.writeInt(BINARY_VERSION);
+
+    out.writeString(juce::String(midiDeviceName));
+    out.writeInt(chordChannel);
+    out.writeInt(strumChannel);
+    out.writeInt(strumCooldownMs);
+    out.writeInt(strumGateTimeMs);
+    out.writeInt(strumPlateCC);
+
+    nlohmann::json chordStyle;
+    nlohmann::json strumStyle;
+    if (chordVoicingStyle) {
+        chordVoicingStyle->to_json(chordStyle);
+    }
+    if (strumVoicingStyle) {
+        strumVoicingStyle->to_json(strumStyle);
+    }
+    writeStyle(out, chordStyle);
+    writeStyle(out, strumStyle);
+    out.writeByte(static_cast<char>(voicingModifier));
+
+    std::visit(
+        [&out](auto&& arg) {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr (std::is_same_v<T, ButtonPerChordQuality>) {
+                out.writeByte(static_cast<char>(BUTTON_PER_CHORD_QUALITY));
+                writeQualityMap(out, arg.notes);
+                writeQualityMap(out, arg.ccs);
+            } else if constexpr (std::is_same_v<T, CCRangePerChordQuality>) {
+                out.writeByte(static_cast<char>(CC_RANGE_PER_CHORD_QUALITY));
+                out.writeInt(arg.cc);
+            }
+        },
+        chordQualitySelectionStyle.value);
+
+    writeButton(out, latchButton);
+    writeButton(out, stopButton);
+}
+
+OmnifySettings OmnifySettings::from_binary(juce::InputStream& in, VoicingStyleRegistry<VoicingFor::Chord>& chordRegistry,
+                                           VoicingStyleRegistry<VoicingFor::Strum>& strumRegistry) {
+    if (readInt(in) != BINARY_MAGIC) {
+        throw std::runtime_error("Not OmnifySettings binary data");
+    }
+    auto version = readInt(in);
+    if (version < 1 || version > BINARY_VERSION) {
+        throw std::runtime_error("Unsupported OmnifySettings binary version: " + std::to_string(version));
+    }
+
+    OmnifySettings settings;
+    settings.midiDeviceName = readString(in);
+    settings.chordChannel = readInt(in);
+    settings.strumChannel = readInt(in);
+    settings.strumCooldownMs = readInt(in);
+    settings.strumGateTimeMs = readInt(in);
+    settings.strumPlateCC = readInt(in);
+
+    settings.chordVoicingStyle = readStyle(in, chordRegistry);
+    settings.strumVoicingStyle = readStyle(in, strumRegistry);
+    auto modifier = readByte(in);
+    if (modifier < static_cast<juce::int8>(VoicingModifier::FIXED) || modifier > static_cast<juce::int8>(VoicingModifier::SMOOTH)) {
+        throw std::runtime_error("OmnifySettings binary data has an unknown voicing modifier");
+    }
+    settings.voicingModifier = static_cast<VoicingModifier>(modifier);
+
+    auto selectionType = readByte(in);
+    if (selectionType == BUTTON_PER_CHORD_QUALITY) {
+        auto notes = readQualityMap(in);
+        auto ccs = readQualityMap(in);
+        settings.chordQualitySelectionStyle = ChordQualitySelectionStyle(ButtonPerChordQuality(std::move(notes), std::move(ccs)));
+    } else if (selectionType == CC_RANGE_PER_CHORD_QUALITY) {
+        settings.chordQualitySelectionStyle = ChordQualitySelectionStyle(CCRangePerChordQuality(readInt(in)));
+    } else {
+        throw std::runtime_error("OmnifySettings binary data has an unknown chord quality selection style");
+    }
+
+    settings.latchButton = readButton(in);
+    settings.stopButton = readButton(in);
+
+    return settings;
+}
+
+bool OmnifySettings::isBinary(const void* data, size_t size) {
+    return size >= 4 && juce::ByteOrder::littleEndianInt(data) == static_cast<juce::uint32>(BINARY_MAGIC);
+}
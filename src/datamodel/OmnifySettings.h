@@ -1,5 +1,7 @@
 #pragma once
 
+#include <juce_core/juce_core.h>
+
 #include <json.hpp>
 #include <memory>
 #include <string>
@@ -32,4 +34,15 @@ class OmnifySettings {
     nlohmann::json to_json() const;
     static OmnifySettings from_json(const nlohmann::json& j, VoicingStyleRegistry<VoicingFor::Chord>& chordRegistry,
                                     VoicingStyleRegistry<VoicingFor::Strum>& strumRegistry);
+
+    // Compact versioned binary form, for plugin state. Loads without parsing the whole settings as JSON,
+    // only the (small) voicing style objects, so each style keeps its own serialization.
+    static constexpr juce::int32 BINARY_MAGIC = 0x534e4d4f;  // "OMNS"
+    static constexpr juce::int32 BINARY_VERSION = 1;
+
+    void to_binary(juce::OutputStream& out) const;
+    // Throws if the data is truncated, from a newer version, or otherwise invalid
+    static OmnifySettings from_binary(juce::InputStream& in, VoicingStyleRegistry<VoicingFor::Chord>& chordRegistry,
+                                      VoicingStyleRegistry<VoicingFor::Strum>& strumRegistry);
+    static bool isBinary(const void* data, size_t size);
 };
\ No newline at end of file
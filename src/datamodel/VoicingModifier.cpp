@@ -0,0 +1,62 @@
+#include "VoicingModifier.h"
+
+#include <algorithm>
+
+std::vector<int> applyVoicingModifier(const VoicingStyle<VoicingFor::Chord>& style, VoicingModifier modifier, ChordQuality quality, int root) {
+    switch (modifier) {
+        case VoicingModifier::NONE:
+            return style.constructChord(quality, root);
+        case VoicingModifier::FIXED:
+            return style.constructChord(quality, 60 + (root % 12));
+        case VoicingModifier::SMOOTH:
+            break;
+    }
+
+    auto normalizedRoot = 60 + (root % 12);
+    auto middleOctaveNotes = style.constructChord(quality, normalizedRoot);
+    std::vector<int> offsets;
+    offsets.reserve(middleOctaveNotes.size());
+    for (int x : middleOctaveNotes) {
+        offsets.push_back(x - 60);
+    }
+    return smoothVoicing(std::move(offsets), root);
+}
+
+std::vector<int> smoothVoicing(std::vector<int> offsets, int root) {
+    std::sort(offsets.begin(), offsets.end());
+    auto octave = root / 12;
+    auto pitchClass = root % 12;
+    std::vector<int> notes;
+    notes.reserve(offsets.size());
+
+    std::vector<int> inversionOffsets(offsets.size(), 0);
+
+    // Inversions need at least two notes to move around
+    if (offsets.size() >= 2) {
+        switch (octave) {
+            case 3:
+                inversionOffsets[inversionOffsets.size() - 2] = -12;
+                inversionOffsets[inversionOffsets.size() - 1] = -12;
+                break;
+            case 4:
+                inversionOffsets[inversionOffsets.size() - 1] = -12;
+                break;
+            // case 5: middle octave, do nothing
+            case 6:
+                inversionOffsets[0] = 12;
+                break;
+            case 7:
+                inversionOffsets[0] = 12;
+                inversionOffsets[1] = 12;
+                break;
+            default:
+                break;
+        }
+    }
+
+    for (size_t i = 0; i < offsets.size(); i++) {
+        notes.push_back(60 + pitchClass + offsets[i] + inversionOffsets[i]);
+    }
+
+    return notes;
+}
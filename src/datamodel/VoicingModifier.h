@@ -1,6 +1,10 @@
 #pragma once
 
 #include <json.hpp>
+#include <vector>
+
+#include "ChordQuality.h"
+#include "VoicingStyle.h"
 
 enum class VoicingModifier { FIXED, NONE, SMOOTH };
 
@@ -9,3 +13,10 @@ NLOHMANN_JSON_SERIALIZE_ENUM(VoicingModifier, {
     {VoicingModifier::NONE, "NONE"},
     {VoicingModifier::SMOOTH, "SMOOTH"},
 })
+
+// Builds the chord for (quality, root) from style, transformed by modifier.
+// FIXED voices every root in the middle octave, SMOOTH picks inversions that keep the chord near the middle octave.
+std::vector<int> applyVoicingModifier(const VoicingStyle<VoicingFor::Chord>& style, VoicingModifier modifier, ChordQuality quality, int root);
+
+// Places offsets (relative to a middle-octave root) around root, inverting to stay close to the middle octave
+std::vector<int> smoothVoicing(std::vector<int> offsets, int root);
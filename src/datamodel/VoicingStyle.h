@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <json.hpp>
 #include <map>
@@ -33,6 +34,13 @@ class VoicingStyle {
     virtual std::string description() const = 0;
     virtual std::vector<int> constructChord(ChordQuality quality, int root) const = 0;
     virtual void to_json(nlohmann::json& j) const = 0;
+
+    // For styles whose data loads in the background: changes whenever constructChord's results change
+    // without the style being replaced, so anything compiled from it knows to recompile
+    virtual uint64_t getDataVersion() const { return 0; }
+
+    // Blocks until any background load in progress has finished. Never call from the engine thread.
+    virtual void waitForData() const {}
 };
 
 // Registry of available voicing styles - one per plugin instance.
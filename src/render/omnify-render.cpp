@@ -0,0 +1,175 @@
+// Offline render: pushes a recorded .mid performance through Omnify on a virtual clock, as fast as possible,
+// and writes everything it produces (including scheduled strum note-offs) to a new .mid file.
+//
+//   omnify-render --settings settings.json --in performance.mid --out rendered.mid
+//
+// The settings file uses the same schema as the plugin's saved settings (OmnifySettings::from_json).
+// Output is deterministic, so the same input and settings always render the same bytes.
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <json.hpp>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Clock.h"
+#include "MidiMessageScheduler.h"
+#include "MidiSink.h"
+#include "Omnify.h"
+#include "TimestampedMidiEvent.h"
+#include "datamodel/OmnifySettings.h"
+#include "voicing_styles/BuiltinVoicingStyles.h"
+
+namespace {
+
+// 960 ticks per quarter note at 120 bpm, so 1920 ticks per second
+constexpr int TICKS_PER_QUARTER_NOTE = 960;
+constexpr int MICROSECONDS_PER_QUARTER_NOTE = 500000;
+constexpr double TICKS_PER_SECOND = TICKS_PER_QUARTER_NOTE * 1e6 / MICROSECONDS_PER_QUARTER_NOTE;
+
+struct Options {
+    std::string settingsPath;
+    std::string inPath;
+    std::string outPath;
+};
+
+std::optional<Options> parseOptions(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--settings" && i + 1 < argc) {
+            options.settingsPath = argv[++i];
+        } else if (arg == "--in" && i + 1 < argc) {
+            options.inPath = argv[++i];
+        } else if (arg == "--out" && i + 1 < argc) {
+            options.outPath = argv[++i];
+        } else {
+            return std::nullopt;
+        }
+    }
+    if (options.settingsPath.empty() || options.inPath.empty() || options.outPath.empty()) {
+        return std::nullopt;
+    }
+    return options;
+}
+
+// Collects engine output at its intended time, in file ticks
+class SequenceSink : public MidiSink {
+   public:
+    juce::MidiMessageSequence sequence;
+
+    void send(MidiEvent event, TimeNs timeNs) override {
+        auto ticks = std::round(static_cast<double>(timeNs) * TICKS_PER_SECOND / 1e9);
+        sequence.addEvent(event.toMidiMessage(), ticks);
+    }
+};
+
+// Merges every track of the file into one sequence of input events, timed from the start of the file
+std::vector<TimestampedMidiEvent> readInputEvents(const juce::File& file) {
+    juce::FileInputStream in(file);
+    juce::MidiFile midiFile;
+    if (!in.openedOk() || !midiFile.readFrom(in)) {
+        throw std::runtime_error("Can't read MIDI file: " + file.getFullPathName().toStdString());
+    }
+    midiFile.convertTimestampTicksToSeconds();
+
+    juce::MidiMessageSequence merged;
+    for (int t = 0; t < midiFile.getNumTracks(); ++t) {
+        merged.addSequence(*midiFile.getTrack(t), 0.0);
+    }
+    merged.sort();
+
+    std::vector<TimestampedMidiEvent> events;
+    events.reserve(static_cast<size_t>(merged.getNumEvents()));
+    for (const auto* holder : merged) {
+        TimestampedMidiEvent event;
+        // Meta events and sysex don't fit, and Omnify ignores them anyway
+        if (TimestampedMidiEvent::fromMidiMessage(holder->message, SystemClock::fromMidiTimestamp(holder->message.getTimeStamp()), event)) {
+            events.push_back(event);
+        }
+    }
+    return events;
+}
+
+void writeOutput(const juce::File& file, juce::MidiMessageSequence& sequence) {
+    juce::MidiMessageSequence track;
+    track.addEvent(juce::MidiMessage::tempoMetaEvent(MICROSECONDS_PER_QUARTER_NOTE), 0.0);
+    track.addSequence(sequence, 0.0);
+
+    juce::MidiFile midiFile;
+    midiFile.setTicksPerQuarterNote(TICKS_PER_QUARTER_NOTE);
+    midiFile.addTrack(track);
+
+    file.deleteFile();
+    juce::FileOutputStream out(file);
+    if (!out.openedOk() || !midiFile.writeTo(out)) {
+        throw std::runtime_error("Can't write MIDI file: " + file.getFullPathName().toStdString());
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    auto options = parseOptions(argc, argv);
+    if (!options) {
+        std::cerr << "Usage: " << argv[0] << " --settings settings.json --in performance.mid --out rendered.mid\n";
+        return 1;
+    }
+
+    VoicingStyleRegistry<VoicingFor::Chord> chordRegistry;
+    VoicingStyleRegistry<VoicingFor::Strum> strumRegistry;
+    registerBuiltinVoicingStyles(chordRegistry, strumRegistry);
+
+    try {
+        std::ifstream settingsIn(options->settingsPath);
+        if (!settingsIn) {
+            throw std::runtime_error("Can't open settings file: " + options->settingsPath);
+        }
+        auto settings = std::make_shared<OmnifySettings>(OmnifySettings::from_json(nlohmann::json::parse(settingsIn), chordRegistry, strumRegistry));
+        // Chord files load in the background, and a render has to use them from the first event
+        settings->chordVoicingStyle->waitForData();
+        settings->strumVoicingStyle->waitForData();
+
+        auto events = readInputEvents(juce::File::getCurrentWorkingDirectory().getChildFile(options->inPath));
+
+        VirtualClock clock;
+        MidiMessageScheduler scheduler;
+        Omnify omnify(scheduler, settings, std::make_shared<RealtimeParams>(), clock);
+        SequenceSink sink;
+
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& event : events) {
+            // Scheduled messages due by this event go out first, in case it reschedules them
+            clock.set(event.timeNs);
+            scheduler.sendOverdueMessages(event.timeNs, sink);
+            omnify.process(std::span(&event, 1), sink);
+        }
+        // Let every pending note-off play out
+        while (auto next = scheduler.nextSendTime()) {
+            clock.set(*next);
+            scheduler.sendOverdueMessages(*next, sink);
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        writeOutput(juce::File::getCurrentWorkingDirectory().getChildFile(options->outPath), sink.sequence);
+
+        std::cerr << "Rendered " << events.size() << " input events to " << sink.sequence.getNumEvents() << " output events in "
+                  << elapsed * 1000.0 << " ms (" << (elapsed > 0 ? static_cast<double>(events.size()) / elapsed : 0.0) << " events/s)";
+        if (scheduler.getNumDropped() > 0) {
+            std::cerr << ", " << scheduler.getNumDropped() << " scheduled messages dropped";
+        }
+        std::cerr << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Render failed: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
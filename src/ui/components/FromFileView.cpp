@@ -56,7 +56,7 @@ void FromFileView::mouseDown(const juce::MouseEvent& event) {
 }
 
 void FromFileView::launchFileBrowser() {
-    fileChooser = std::make_unique<juce::FileChooser>("Select voicing file", juce::File{}, "*.json");
+    fileChooser = std::make_unique<juce::FileChooser>("Select voicing file", juce::File{}, "*.json;*.omct");
 
     auto flags = juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles;
 
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../datamodel/VoicingStyle.h"
+
+/*
+ * A chord file compiled into the binary. omnify-chordgen generates these from the JSON files in
+ * Omnichord Facts at build time (see BuiltinChordTables.h in the build tree), so the data lives in
+ * read-only static storage: no file access, parsing or heap, and nothing that can fail to load.
+ *
+ * Voicings are keyed by pitch class, like FromFile's 12-key chord files.
+ */
+struct BuiltinChordTable {
+    static constexpr size_t MAX_NOTES = 8;
+    static constexpr size_t NUM_PITCH_CLASSES = 12;
+
+    struct Voicing {
+        uint8_t count;
+        std::array<int8_t, MAX_NOTES> notes;
+    };
+
+    std::string_view name;
+    std::string_view description;
+    bool isOffsetTable;                                                                     // notes are offsets from the root
+    std::array<std::array<Voicing, NUM_PITCH_CLASSES>, ALL_CHORD_QUALITIES.size()> voicings;  // [quality][pitch class]
+};
+
+// A voicing style backed by a generated table
+class BuiltinChordFile : public VoicingStyle<VoicingFor::Chord> {
+   public:
+    BuiltinChordFile(std::string typeName, const BuiltinChordTable& table) : typeName(std::move(typeName)), table(table) {}
+
+    std::string displayName() const override { return std::string(table.name); }
+    std::string description() const override { return std::string(table.description); }
+
+    std::vector<int> constructChord(ChordQuality quality, int root) const override {
+        const auto& voicing = table.voicings[static_cast<size_t>(quality)][static_cast<size_t>(((root % 12) + 12) % 12)];
+        auto base = table.isOffsetTable ? root : 0;
+
+        std::vector<int> notes;
+        notes.reserve(voicing.count);
+        for (size_t i = 0; i < voicing.count; ++i) {
+            notes.push_back(base + voicing.notes[i]);
+        }
+        return notes;
+    }
+
+    void to_json(nlohmann::json& j) const override { j = nlohmann::json{{"type", typeName}}; }
+
+    // Every instance of a table is the same, so the registry's factory just makes another
+    static VoicingStyleFactory<VoicingFor::Chord> factory(std::string typeName, const BuiltinChordTable& table) {
+        return [typeName = std::move(typeName), &table](const nlohmann::json&) { return std::make_shared<BuiltinChordFile>(typeName, table); };
+    }
+
+   private:
+    std::string typeName;
+    const BuiltinChordTable& table;
+};
@@ -0,0 +1,26 @@
+#include "BuiltinVoicingStyles.h"
+
+#include "BuiltinChordTable.h"
+#include "BuiltinChordTables.h"  // generated from Omnichord Facts
+#include "FromFile.h"
+#include "Omni84.h"
+#include "OmnichordChords.h"
+#include "OmnichordStrum.h"
+#include "PlainAscending.h"
+#include "RootPosition.h"
+
+void registerBuiltinVoicingStyles(VoicingStyleRegistry<VoicingFor::Chord>& chordRegistry, VoicingStyleRegistry<VoicingFor::Strum>& strumRegistry) {
+    chordRegistry.registerStyle("RootPosition", std::make_shared<RootPosition>(), RootPosition::from_json);
+    chordRegistry.registerStyle("FromFile", std::make_shared<FromFile<VoicingFor::Chord>>(""), FromFile<VoicingFor::Chord>::from_json);
+    chordRegistry.registerStyle("Omnichord", std::make_shared<OmnichordChords>(), OmnichordChords::from_json);
+
+    chordRegistry.registerStyle("Omni84", std::make_shared<Omni84>(), Omni84::from_json);
+
+    chordRegistry.registerStyle("OM108Fixed", std::make_shared<BuiltinChordFile>("OM108Fixed", OM108_FIXED),
+                                BuiltinChordFile::factory("OM108Fixed", OM108_FIXED));
+    chordRegistry.registerStyle("OM108Relative", std::make_shared<BuiltinChordFile>("OM108Relative", OM108_RELATIVE),
+                                BuiltinChordFile::factory("OM108Relative", OM108_RELATIVE));
+
+    strumRegistry.registerStyle("PlainAscending", std::make_shared<PlainAscending>(), PlainAscending::from_json);
+    strumRegistry.registerStyle("Omnichord", std::make_shared<OmnichordStrum>(), OmnichordStrum::from_json);
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+#include "../datamodel/VoicingStyle.h"
+
+// Registers every voicing style that ships with Omnify, so any front-end can load saved settings
+void registerBuiltinVoicingStyles(VoicingStyleRegistry<VoicingFor::Chord>& chordRegistry, VoicingStyleRegistry<VoicingFor::Strum>& strumRegistry);
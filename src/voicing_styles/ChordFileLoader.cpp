@@ -0,0 +1,48 @@
+#include "ChordFileLoader.h"
+
+#include <algorithm>
+
+ChordFileLoader& ChordFileLoader::instance() {
+    static ChordFileLoader loader;
+    return loader;
+}
+
+ChordFileLoader::ChordFileLoader() : thread([this] { run(); }) {}
+
+ChordFileLoader::~ChordFileLoader() {
+    {
+        std::scoped_lock lock(mutex);
+        shouldExit.store(true);
+    }
+    wake.notify_all();
+    thread.join();
+}
+
+void ChordFileLoader::enqueue(const void* key, Job job) {
+    {
+        std::scoped_lock lock(mutex);
+        auto queued = std::find_if(queue.begin(), queue.end(), [key](const auto& entry) { return entry.first == key; });
+        if (queued != queue.end()) {
+            queued->second = std::move(job);
+        } else {
+            queue.emplace_back(key, std::move(job));
+        }
+    }
+    wake.notify_one();
+}
+
+void ChordFileLoader::run() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock lock(mutex);
+            wake.wait(lock, [this] { return shouldExit.load() || !queue.empty(); });
+            if (shouldExit.load()) {
+                return;
+            }
+            job = std::move(queue.front().second);
+            queue.pop_front();
+        }
+        job();
+    }
+}
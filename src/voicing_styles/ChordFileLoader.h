@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+/*
+ * Loads chord files on one background thread, so reading and parsing them never blocks the UI or the engine.
+ *
+ * Loads are queued per key (eg a FromFile style's shared state). Queueing a load for a key that already has
+ * one waiting replaces it, since only the newest request for a file matters, so bursts of path changes or
+ * file edits don't pile up. The thread is joined when the loader is destroyed, dropping anything still queued.
+ */
+class ChordFileLoader {
+   public:
+    using Job = std::function<void()>;
+
+    static ChordFileLoader& instance();
+
+    void enqueue(const void* key, Job job);
+
+    ~ChordFileLoader();
+
+    ChordFileLoader(const ChordFileLoader&) = delete;
+    ChordFileLoader& operator=(const ChordFileLoader&) = delete;
+
+   private:
+    ChordFileLoader();
+
+    std::mutex mutex;  // guards queue
+    std::condition_variable wake;
+    std::deque<std::pair<const void*, Job>> queue;
+
+    std::atomic<bool> shouldExit{false};
+    std::thread thread;
+
+    void run();
+};
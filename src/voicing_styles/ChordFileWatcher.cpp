@@ -0,0 +1,159 @@
+#include "ChordFileWatcher.h"
+
+#include <chrono>
+#include <filesystem>
+#include <set>
+#include <system_error>
+#include <vector>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+int64_t lastModifiedOf(const std::string& path) {
+    std::error_code ec;
+    auto time = std::filesystem::last_write_time(path, ec);
+    return ec ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+}  // namespace
+
+void ChordFileWatcher::Watch::reset() {
+    if (id != 0) {
+        ChordFileWatcher::instance().unwatch(id);
+        id = 0;
+    }
+}
+
+ChordFileWatcher& ChordFileWatcher::instance() {
+    static ChordFileWatcher watcher;
+    return watcher;
+}
+
+ChordFileWatcher::ChordFileWatcher() : thread([this] { run(); }) {}
+
+ChordFileWatcher::~ChordFileWatcher() {
+    shouldExit.store(true);
+    thread.join();
+}
+
+ChordFileWatcher::Watch ChordFileWatcher::watch(const std::string& path, Callback onChange) {
+    std::scoped_lock lock(mutex);
+    auto id = nextId++;
+    entries[id] = Entry{path, std::move(onChange), lastModifiedOf(path)};
+    watchesChanged.store(true);
+    return Watch(id);
+}
+
+void ChordFileWatcher::unwatch(uint64_t id) {
+    std::scoped_lock lock(mutex);
+    entries.erase(id);
+    watchesChanged.store(true);
+}
+
+#if defined(__linux__)
+
+void ChordFileWatcher::run() {
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+
+    // One watch per directory holding a watched file
+    std::map<std::string, int> dirToWd;
+    std::map<int, std::string> wdToDir;
+    alignas(inotify_event) char buffer[4096];
+
+    while (!shouldExit.load()) {
+        if (watchesChanged.exchange(false)) {
+            std::set<std::string> wanted;
+            {
+                std::scoped_lock lock(mutex);
+                for (const auto& [id, entry] : entries) {
+                    wanted.insert(std::filesystem::path(entry.path).parent_path().string());
+                }
+            }
+            for (auto it = dirToWd.begin(); it != dirToWd.end();) {
+                if (wanted.count(it->first) == 0) {
+                    inotify_rm_watch(fd, it->second);
+                    wdToDir.erase(it->second);
+                    it = dirToWd.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            for (const auto& dir : wanted) {
+                if (dirToWd.count(dir) == 0) {
+                    auto wd = inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+                    if (wd >= 0) {
+                        dirToWd[dir] = wd;
+                        wdToDir[wd] = dir;
+                    }
+                }
+            }
+        }
+
+        pollfd pfd{fd, POLLIN, 0};
+        if (poll(&pfd, 1, POLL_INTERVAL_MS) <= 0) {
+            continue;
+        }
+
+        // Collect every changed path in this burst, so each watcher is called once
+        std::set<std::string> changed;
+        ssize_t length = 0;
+        while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+            for (char* p = buffer; p < buffer + length;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(p);
+                auto dir = wdToDir.find(event->wd);
+                if (dir != wdToDir.end() && event->len > 0) {
+                    changed.insert((std::filesystem::path(dir->second) / event->name).string());
+                }
+                p += sizeof(inotify_event) + event->len;
+            }
+        }
+
+        std::vector<Callback> callbacks;
+        {
+            std::scoped_lock lock(mutex);
+            for (const auto& [id, entry] : entries) {
+                if (changed.count(entry.path) > 0) {
+                    callbacks.push_back(entry.onChange);
+                }
+            }
+        }
+        for (const auto& callback : callbacks) {
+            callback();
+        }
+    }
+
+    close(fd);
+}
+
+#else
+
+void ChordFileWatcher::run() {
+    while (!shouldExit.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS));
+
+        std::vector<Callback> callbacks;
+        {
+            std::scoped_lock lock(mutex);
+            for (auto& [id, entry] : entries) {
+                auto modified = lastModifiedOf(entry.path);
+                if (modified != entry.lastModified) {
+                    entry.lastModified = modified;
+                    callbacks.push_back(entry.onChange);
+                }
+            }
+        }
+        for (const auto& callback : callbacks) {
+            callback();
+        }
+    }
+}
+
+#endif
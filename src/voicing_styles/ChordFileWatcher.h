@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+/*
+ * Watches chord files for changes on one background thread, so edits are picked up without touching the UI.
+ *
+ * Uses inotify on Linux, watching each file's directory so editors that save by renaming a temp file
+ * over the original are caught too. Other platforms fall back to polling modification times.
+ * Callbacks run on the watcher thread, at most once per burst of changes to a file.
+ */
+class ChordFileWatcher {
+   public:
+    using Callback = std::function<void()>;
+
+    // Unwatches when destroyed
+    class Watch {
+       public:
+        Watch() = default;
+        Watch(Watch&& other) noexcept : id(std::exchange(other.id, 0)) {}
+        Watch& operator=(Watch&& other) noexcept {
+            if (this != &other) {
+                reset();
+                id = std::exchange(other.id, 0);
+            }
+            return *this;
+        }
+        ~Watch() { reset(); }
+
+        Watch(const Watch&) = delete;
+        Watch& operator=(const Watch&) = delete;
+
+        void reset();
+
+       private:
+        friend class ChordFileWatcher;
+        explicit Watch(uint64_t id) : id(id) {}
+        uint64_t id = 0;
+    };
+
+    static ChordFileWatcher& instance();
+
+    // path should be absolute. onChange may still run briefly after the Watch is reset.
+    Watch watch(const std::string& path, Callback onChange);
+
+    ~ChordFileWatcher();
+
+    ChordFileWatcher(const ChordFileWatcher&) = delete;
+    ChordFileWatcher& operator=(const ChordFileWatcher&) = delete;
+
+   private:
+    ChordFileWatcher();
+
+    static constexpr int POLL_INTERVAL_MS = 250;
+
+    struct Entry {
+        std::string path;
+        Callback onChange;
+        int64_t lastModified = 0;  // polling fallback only
+    };
+
+    std::mutex mutex;  // guards entries
+    std::map<uint64_t, Entry> entries;
+    uint64_t nextId = 1;
+    std::atomic<bool> watchesChanged{false};
+
+    std::atomic<bool> shouldExit{false};
+    std::thread thread;
+
+    void unwatch(uint64_t id);
+    void run();
+};
@@ -0,0 +1,182 @@
+#include "ChordTable.h"
+
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <stdexcept>
+
+namespace {
+
+template <typename T>
+void append(std::vector<std::byte>& image, const T& value) {
+    const auto* bytes = reinterpret_cast<const std::byte*>(&value);
+    image.insert(image.end(), bytes, bytes + sizeof(T));
+}
+
+}  // namespace
+
+std::shared_ptr<const ChordTable> ChordTable::fromJson(const nlohmann::json& j) {
+    auto tableName = j.at("name").get<std::string>();
+    auto tableDescription = j.at("description").get<std::string>();
+    auto isOffsetFile = j.at("isOffsetFile").get<bool>();
+
+    // JSON has string keys, so we parse quality names and root numbers from strings
+    std::map<ChordQuality, std::map<int, std::vector<int>>> chords;
+    for (const auto& [qualityName, rootMap] : j.at("chords").items()) {
+        ChordQuality quality = chordQualityFromName(qualityName);
+        for (const auto& [rootStr, notes] : rootMap.items()) {
+            chords[quality][std::stoi(rootStr)] = notes.get<std::vector<int>>();
+        }
+    }
+
+    // Keyed by pitch class (0-11) or by every root (0-127), the same for every quality
+    uint16_t numKeys = 0;
+    for (auto quality : ALL_CHORD_QUALITIES) {
+        const auto& qualityName = getChordQualityData(quality).name;
+        auto it = chords.find(quality);
+        if (it == chords.end()) {
+            throw std::runtime_error("Chord file is missing quality " + qualityName);
+        }
+        auto keys = static_cast<uint16_t>(it->second.size());
+        if (numKeys == 0) {
+            numKeys = keys;
+        }
+        if (keys != numKeys || (keys != NUM_PITCH_CLASSES && keys != NUM_ROOTS)) {
+            throw std::runtime_error("Chord file must have a voicing for all 12 pitch classes or all 128 roots of every quality, " +
+                                     qualityName + " has " + std::to_string(keys));
+        }
+        for (int key = 0; key < numKeys; ++key) {
+            auto voicing = it->second.find(key);
+            if (voicing == it->second.end() || voicing->second.empty()) {
+                throw std::runtime_error("Chord file has no voicing for " + qualityName + " on " + std::to_string(key));
+            }
+            for (int note : voicing->second) {
+                if (note < std::numeric_limits<int16_t>::min() || note > std::numeric_limits<int16_t>::max()) {
+                    throw std::runtime_error("Chord file note out of range for " + qualityName + " on " + std::to_string(key));
+                }
+            }
+        }
+    }
+
+    std::vector<IndexEntry> entries;
+    std::vector<int16_t> allNotes;
+    for (auto quality : ALL_CHORD_QUALITIES) {
+        for (int key = 0; key < numKeys; ++key) {
+            const auto& voicing = chords[quality][key];
+            entries.push_back({static_cast<uint32_t>(allNotes.size()), static_cast<uint32_t>(voicing.size())});
+            for (int note : voicing) {
+                allNotes.push_back(static_cast<int16_t>(note));
+            }
+        }
+    }
+
+    Header header{};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.flags = isOffsetFile ? FLAG_OFFSETS : 0;
+    header.numQualities = static_cast<uint16_t>(ALL_CHORD_QUALITIES.size());
+    header.numKeys = numKeys;
+    header.numNotes = static_cast<uint32_t>(allNotes.size());
+    header.nameBytes = static_cast<uint32_t>(tableName.size());
+    header.descriptionBytes = static_cast<uint32_t>(tableDescription.size());
+
+    std::shared_ptr<ChordTable> table(new ChordTable());
+    auto& image = table->ownedImage;
+    append(image, header);
+    for (const auto& entry : entries) {
+        append(image, entry);
+    }
+    for (auto note : allNotes) {
+        append(image, note);
+    }
+    const auto* nameBytes = reinterpret_cast<const std::byte*>(tableName.data());
+    image.insert(image.end(), nameBytes, nameBytes + tableName.size());
+    const auto* descriptionBytes = reinterpret_cast<const std::byte*>(tableDescription.data());
+    image.insert(image.end(), descriptionBytes, descriptionBytes + tableDescription.size());
+
+    table->attach(image);
+    return table;
+}
+
+std::shared_ptr<const ChordTable> ChordTable::fromBinaryFile(const std::string& path) {
+    juce::MemoryMappedFile mappedFile(juce::File(path), juce::MemoryMappedFile::readOnly);
+    if (mappedFile.getData() == nullptr) {
+        throw std::runtime_error("Can't map chord file " + path);
+    }
+
+    // Copied before validating, so rewriting the file in place later can't change (or truncate) a table in use.
+    // Tables are a few KB, so this costs next to nothing.
+    std::shared_ptr<ChordTable> table(new ChordTable());
+    const auto* data = static_cast<const std::byte*>(mappedFile.getData());
+    table->ownedImage.assign(data, data + mappedFile.getSize());
+    table->attach(table->ownedImage);
+    return table;
+}
+
+std::shared_ptr<const ChordTable> ChordTable::fromFile(const std::string& path) {
+    if (isBinaryFile(path)) {
+        return fromBinaryFile(path);
+    }
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Can't open chord file " + path);
+    }
+    nlohmann::json j;
+    file >> j;
+    return fromJson(j);
+}
+
+bool ChordTable::isBinaryFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::array<char, 4> magic{};
+    return file.read(magic.data(), magic.size()) && magic == MAGIC;
+}
+
+void ChordTable::writeBinary(std::ostream& out) const {
+    out.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));
+}
+
+void ChordTable::attach(std::span<const std::byte> bytes) {
+    static_assert(std::endian::native == std::endian::little, "Chord tables are little-endian and used in place");
+
+    if (bytes.size() < sizeof(Header)) {
+        throw std::runtime_error("Chord table is truncated");
+    }
+    std::memcpy(&fileHeader, bytes.data(), sizeof(Header));
+    if (fileHeader.magic != MAGIC) {
+        throw std::runtime_error("Not a chord table");
+    }
+    if (fileHeader.version != VERSION) {
+        throw std::runtime_error("Unsupported chord table version " + std::to_string(fileHeader.version));
+    }
+    if (fileHeader.numQualities != ALL_CHORD_QUALITIES.size()) {
+        throw std::runtime_error("Chord table has " + std::to_string(fileHeader.numQualities) + " qualities, expected " +
+                                 std::to_string(ALL_CHORD_QUALITIES.size()));
+    }
+    if (fileHeader.numKeys != NUM_PITCH_CLASSES && fileHeader.numKeys != NUM_ROOTS) {
+        throw std::runtime_error("Chord table must be keyed by 12 pitch classes or 128 roots");
+    }
+
+    auto numEntries = static_cast<size_t>(fileHeader.numQualities) * fileHeader.numKeys;
+    auto indexOffset = sizeof(Header);
+    auto notesOffset = indexOffset + (numEntries * sizeof(IndexEntry));
+    auto nameOffset = notesOffset + (static_cast<size_t>(fileHeader.numNotes) * sizeof(int16_t));
+    auto descriptionOffset = nameOffset + fileHeader.nameBytes;
+    if (bytes.size() != descriptionOffset + fileHeader.descriptionBytes) {
+        throw std::runtime_error("Chord table size doesn't match its header");
+    }
+
+    image = bytes;
+    index = {reinterpret_cast<const IndexEntry*>(bytes.data() + indexOffset), numEntries};
+    notes = {reinterpret_cast<const int16_t*>(bytes.data() + notesOffset), fileHeader.numNotes};
+    name.assign(reinterpret_cast<const char*>(bytes.data() + nameOffset), fileHeader.nameBytes);
+    description.assign(reinterpret_cast<const char*>(bytes.data() + descriptionOffset), fileHeader.descriptionBytes);
+
+    for (const auto& entry : index) {
+        if (entry.count == 0 || entry.first > fileHeader.numNotes || entry.count > fileHeader.numNotes - entry.first) {
+            throw std::runtime_error("Chord table has an empty or out of range voicing");
+        }
+    }
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <json.hpp>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../datamodel/ChordQuality.h"
+
+/*
+ * The voicings of a chord file, as one flat, validated image.
+ *
+ * Voicings are keyed either by pitch class (12 per quality) or by root (all 128 MIDI notes per quality).
+ * The image is also the binary chord file format, so a binary file is copied in and used as is, with no
+ * parsing, and a JSON file is converted into the same image in memory. Either way, lookup is a bounds-checked
+ * index into flat arrays, and every quality and key is guaranteed to have a voicing.
+ *
+ * Binary layout (little-endian):
+ *   Header, then numQualities * numKeys IndexEntry (qualities in ChordQuality order),
+ *   then numNotes int16 notes, then the UTF-8 name and description.
+ */
+class ChordTable {
+   public:
+    static constexpr std::array<char, 4> MAGIC = {'O', 'M', 'C', 'T'};
+    static constexpr uint16_t VERSION = 1;
+    static constexpr uint16_t NUM_PITCH_CLASSES = 12;
+    static constexpr uint16_t NUM_ROOTS = 128;
+
+    // Parses and validates the JSON chord file format, throwing on any problem
+    static std::shared_ptr<const ChordTable> fromJson(const nlohmann::json& j);
+
+    // Reads and validates a binary chord file, throwing on any problem
+    static std::shared_ptr<const ChordTable> fromBinaryFile(const std::string& path);
+
+    // Loads either format, telling them apart by the binary magic number
+    static std::shared_ptr<const ChordTable> fromFile(const std::string& path);
+
+    static bool isBinaryFile(const std::string& path);
+
+    // Writes the binary format
+    void writeBinary(std::ostream& out) const;
+
+    const std::string& getName() const { return name; }
+    const std::string& getDescription() const { return description; }
+    bool isOffsetTable() const { return (fileHeader.flags & FLAG_OFFSETS) != 0; }
+    bool isPerRoot() const { return fileHeader.numKeys == NUM_ROOTS; }
+
+    // Notes (or offsets from root, for offset tables) for quality at root
+    std::span<const int16_t> lookup(ChordQuality quality, int root) const {
+        auto key = isPerRoot() ? static_cast<size_t>(root) & (NUM_ROOTS - 1) : static_cast<size_t>(((root % 12) + 12) % 12);
+        const auto& entry = index[(static_cast<size_t>(quality) * fileHeader.numKeys) + key];
+        return notes.subspan(entry.first, entry.count);
+    }
+
+   private:
+    static constexpr uint16_t FLAG_OFFSETS = 1;
+
+    struct Header {
+        std::array<char, 4> magic;
+        uint16_t version;
+        uint16_t flags;
+        uint16_t numQualities;
+        uint16_t numKeys;
+        uint32_t numNotes;
+        uint32_t nameBytes;
+        uint32_t descriptionBytes;
+    };
+    static_assert(sizeof(Header) == 24);
+
+    struct IndexEntry {
+        uint32_t first;
+        uint32_t count;
+    };
+    static_assert(sizeof(IndexEntry) == 8);
+
+    // Backs the image, always owned so it can't change after it's been validated
+    std::vector<std::byte> ownedImage;
+
+    // Views into the image, set up by attach()
+    std::span<const std::byte> image;
+    Header fileHeader{};
+    std::span<const IndexEntry> index;
+    std::span<const int16_t> notes;
+    std::string name;
+    std::string description;
+
+    ChordTable() = default;
+
+    // Validates the image and points the views into it
+    void attach(std::span<const std::byte> bytes);
+};
@@ -1,60 +1,57 @@
 #pragma once
 
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
 #include <filesystem>
-#include <fstream>
-#include <map>
-#include <optional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "../ResourcesPath.h"
 #include "../datamodel/VoicingStyle.h"
-
-struct ChordFile {
-    std::string name;
-    std::string description;
-    bool isOffsetFile;
-    std::map<ChordQuality, std::map<int, std::vector<int>>> chords;
-};
-
-// JSON has string keys, so we parse quality names and root numbers from strings
-inline void from_json(const nlohmann::json& j, ChordFile& cf) {
-    j.at("name").get_to(cf.name);
-    j.at("description").get_to(cf.description);
-    j.at("isOffsetFile").get_to(cf.isOffsetFile);
-
-    for (const auto& [qualityName, rootMap] : j.at("chords").items()) {
-        ChordQuality quality = chordQualityFromName(qualityName);
-        for (const auto& [rootStr, notes] : rootMap.items()) {
-            int root = std::stoi(rootStr);
-            cf.chords[quality][root] = notes.get<std::vector<int>>();
-        }
-    }
-}
-
+#include "ChordFileLoader.h"
+#include "ChordFileWatcher.h"
+#include "ChordTable.h"
+
+/*
+ * Voicings loaded from a chord file, either JSON or the binary format made by omnify-chordc (see ChordTable).
+ *
+ * The file is loaded, parsed and validated on ChordFileLoader's thread whenever the path changes,
+ * and the finished data is swapped in atomically. Until then (or if the file is bad) constructChord
+ * throws, which VoicingTable records as a failed entry. Compiled voicings are refreshed when
+ * getDataVersion() moves on, so nothing on the engine thread ever waits on the file.
+ *
+ * The file is also watched, and reloaded the same way when it changes on disk. A reload that fails
+ * (eg the file is caught half-written) keeps the chords it already has. The engine keeps the notes
+ * and strum voicing the sounding chord started with, so new voicings take over cleanly from the next chord.
+ */
 template <VoicingFor T>
 class FromFile : public VoicingStyle<T> {
    public:
-    explicit FromFile(std::string filePath) : path(std::move(filePath)) {}
+    explicit FromFile(std::string filePath) : path(std::move(filePath)) { startLoad(); }
 
     std::string displayName() const override { return "File"; }
     std::string description() const override { return "Load chords from a file. See manual for details."; }
 
     std::vector<int> constructChord(ChordQuality quality, int root) const override {
-        const ChordFile& chordData = getData();
-        int noteClass = root % 12;
-        const auto& offsetsOrNotes = chordData.chords.at(quality).at(noteClass);
-
-        if (chordData.isOffsetFile) {
-            std::vector<int> notes;
-            notes.reserve(offsetsOrNotes.size());
-            for (int offset : offsetsOrNotes) {
-                notes.push_back(root + offset);
-            }
-            return notes;
+        auto chordData = std::atomic_load(&state->data);
+        if (!chordData) {
+            throw std::runtime_error(getLoadError().empty() ? "Chord file not loaded yet" : getLoadError());
+        }
+        // Validated on load, so every quality and key is there
+        auto offsetsOrNotes = chordData->lookup(quality, root);
+        auto base = chordData->isOffsetTable() ? root : 0;
+
+        std::vector<int> notes;
+        notes.reserve(offsetsOrNotes.size());
+        for (int16_t n : offsetsOrNotes) {
+            notes.push_back(base + n);
         }
-        return offsetsOrNotes;
+        return notes;
     }
 
     void to_json(nlohmann::json& j) const override { j = nlohmann::json{{"type", "FromFile"}, {"path", path}}; }
@@ -63,16 +60,45 @@ class FromFile : public VoicingStyle<T> {
         return std::make_shared<FromFile<T>>(j.at("path").get<std::string>());
     }
 
+    uint64_t getDataVersion() const override {
+        std::scoped_lock lock(state->mutex);
+        return state->version;
+    }
+
+    void waitForData() const override {
+        std::unique_lock lock(state->mutex);
+        state->loaded.wait(lock, [this] { return state->completedRequest == state->latestRequest; });
+    }
+
+    // Why the current file couldn't be used, empty if it loaded (or is still loading)
+    std::string getLoadError() const {
+        std::scoped_lock lock(state->mutex);
+        return state->error;
+    }
+
     const std::string& getPath() const { return path; }
 
     void setPath(const std::string& newPath) {
         path = newPath;
-        data.reset();  // Clear cached data so it reloads
+        startLoad();
     }
 
    private:
+    // Shared with the loader and the file watcher, so a load finishing after the style is gone is harmless
+    struct LoadState {
+        std::shared_ptr<const ChordTable> data;  // use std::atomic_load/store
+        std::mutex mutex;                       // guards everything below
+        std::condition_variable loaded;
+        std::string filePath;  // resolved path of the latest request
+        uint64_t latestRequest = 0;
+        uint64_t completedRequest = 0;
+        uint64_t version = 0;
+        std::string error;
+    };
+
     std::string path;
-    mutable std::optional<ChordFile> data;
+    std::shared_ptr<LoadState> state = std::make_shared<LoadState>();
+    ChordFileWatcher::Watch watch;
 
     std::string resolvedPath() const {
         std::filesystem::path p(path);
@@ -83,13 +109,83 @@ class FromFile : public VoicingStyle<T> {
         return (std::filesystem::path(getResourcesBasePath()) / p).string();
     }
 
-    const ChordFile& getData() const {
-        if (!data) {
-            std::ifstream file(resolvedPath());
-            nlohmann::json j;
-            file >> j;
-            data = j.get<ChordFile>();
+    void startLoad() {
+        watch.reset();
+
+        std::string filePath;
+        std::string error;
+        if (path.empty()) {
+            error = "No chord file selected";
+        } else {
+            try {
+                filePath = std::filesystem::absolute(resolvedPath()).string();
+            } catch (const std::exception& e) {
+                error = e.what();
+            }
+        }
+
+        uint64_t request = 0;
+        {
+            std::scoped_lock lock(state->mutex);
+            request = ++state->latestRequest;
+            state->filePath = filePath;
+            state->error.clear();
+        }
+        // The old file's chords no longer apply
+        std::atomic_store(&state->data, std::shared_ptr<const ChordTable>());
+
+        if (filePath.empty()) {
+            finishLoad(state, request, nullptr, error, false);
+            return;
+        }
+
+        // Queued before watching, so the loader is created first and outlives the watcher thread that also queues loads
+        load(state, request, filePath, false);
+
+        watch = ChordFileWatcher::instance().watch(filePath, [weakState = std::weak_ptr<LoadState>(state), filePath] {
+            auto loadState = weakState.lock();
+            if (!loadState) {
+                return;
+            }
+            uint64_t reloadRequest = 0;
+            {
+                std::scoped_lock lock(loadState->mutex);
+                if (loadState->filePath != filePath) {
+                    return;  // the path changed while this was in flight
+                }
+                reloadRequest = ++loadState->latestRequest;
+            }
+            load(loadState, reloadRequest, filePath, true);
+        });
+    }
+
+    static void load(std::shared_ptr<LoadState> loadState, uint64_t request, std::string filePath, bool keepDataOnError) {
+        // A newer request replaces this one if it's still queued, and finishLoad ignores this one once it's stale anyway
+        const auto* key = loadState.get();
+        ChordFileLoader::instance().enqueue(key, [loadState = std::move(loadState), request, filePath = std::move(filePath), keepDataOnError] {
+            try {
+                finishLoad(loadState, request, ChordTable::fromFile(filePath), {}, keepDataOnError);
+            } catch (const std::exception& e) {
+                finishLoad(loadState, request, nullptr, e.what(), keepDataOnError);
+            }
+        });
+    }
+
+    // Publishes the result, unless a newer load has been started since
+    static void finishLoad(const std::shared_ptr<LoadState>& loadState, uint64_t request, std::shared_ptr<const ChordTable> table,
+                           std::string error, bool keepDataOnError) {
+        {
+            std::scoped_lock lock(loadState->mutex);
+            if (request != loadState->latestRequest) {
+                return;
+            }
+            loadState->error = std::move(error);
+            loadState->completedRequest = request;
+            if (table || !keepDataOnError) {
+                std::atomic_store(&loadState->data, std::move(table));
+                ++loadState->version;
+            }
         }
-        return *data;
+        loadState->loaded.notify_all();
     }
 };